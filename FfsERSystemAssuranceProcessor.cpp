@@ -1,2269 +1,6033 @@
-#include FfsERSystemAssuranceProcessor.h
-
-// Static consts
-const AmsString FfsERSystemAssuranceProcessor::BAL = "BAL";
-const AmsString FfsERSystemAssuranceProcessor::NEW = "NEW";
-
-AmsString mstrERSystemAssuranceCode;
-FfsERSystemAssuranceDefinitionPtr madtERSystemAssuranceDefinition;
-AmsBoolean mbDisplayDiscrepanciesOnlyFlag;
-AmsBoolean mbComplexParameterEntered = FALSE;
-
-deque <FfsERSystemAssuranceParameterGroup> madtColumnParameters;
-map<AmsString, map<AmsString, AmsString>*> madtFacts1AttributeNumberCacheMap;
-map<AmsString, map<AmsString, AmsString>*> madtFacts2AttributeNumberCacheMap;
-
-AmsBoolean
-FfsERSystemAssuranceProcessor::ValidateParameters()
-{
-	ValidateERSystemAssuranceDefinitionCode();
-	ValidateDisplayDiscrepanciesOnlyFlag();
-	ValidateComplexParameters();
-
-	return IsOK();
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateComplexParameters()
-{
-	ValidateBalanceSheet();
-	ValidateBudgetaryResources();
-	ValidateChangesInNetPosition();
-	ValidateCustodialActivity();
-	ValidateFinancing();   
-	ValidateNetCost();
-	ValidateSF133();   
-	ValidateFacts1Adjusted();
-	ValidateFacts1Preliminary();
-	ValidateFacts2Adjusted();
-	ValidateFacts2Preliminary();
-	ValidateGLRollup();
-	ValidateComplexParameterExists();
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateERSystemAssuranceDefinitionCode()
-{
-	AmsString strERSystemAssuranceCode = GetParameterValue("ERSystemAssuranceCode");
-	strERSystemAssuranceCode.toUpper();
-	ReportParameterValue("ERSystemAssuranceCode", strERSystemAssuranceCode);
-
-	if (strERSystemAssuranceCode.isNull())
-	{
-		// BA0041E - Parameter %1 is required; hence a value must be entered
-		ReportProblem(AmsProblem("BA0041E") << "ERSystemAssuranceCode");
-		return;
-	}
-
-	mstrERSystemAssuranceCode = strERSystemAssuranceCode;
-	madtERSystemAssuranceDefinition = GetERSystemAssuranceDefinition();
-
-	if (!madtERSystemAssuranceDefinition)
-	{
-		// BJ0018E: Invalid %1 specified: %2
-		ReportProblem(AmsProblem("BJ0018E") << "ERSystemAssuranceCode" << strERSystemAssuranceCode);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateDisplayDiscrepanciesOnlyFlag()
-{
-	mbDisplayDiscrepanciesOnlyFlag = GetBooleanParameterValue ("displayDiscrepanciesOnly");
-	ReportBooleanParameterValue ("displayDiscrepanciesOnly", mbDisplayDiscrepanciesOnlyFlag);
-
-	if(mbDisplayDiscrepanciesOnlyFlag)
-	{
-		AmsBoolean mbTotalExists;  = FALSE;
-
-		for(AmsInt i = 0; i < madtERSystemAssuranceDefinition.Column Count; i++)
-		{
-			ERSystemAssuranceDefinitionColumnPtr padtColumn = padtParentDefinition.Get Column(i);
-
-			if(padtColumn->GetAmountsLiteralIndicator().GetValue() == FfsExternalReportAbstractDefinitionColumn::CURRENT_YEAR_TOTAL)
-			{
-				mbTotalExists = TRUE;
-				return;
-			}
-		}
-
-		if(!mbTotalExists)
-		{
-			// BJ2036E: The displayDiscrepanciesOnly parameter cannot be True if a Total 
-			//Column does not exist on the ER System Assurance Definition specified
-			ReportProblem(AmsProblem("BJ2036E"));
-		}
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateComplexParameterExists()
-{
-	if(!mbComplexParameterEntered)
-	{
-		// BJ2028E: At least one Batch Group Parameter must be entered if 
-		//there are values entered in the Simple Parameters
-		ReportProblem(AmsProblem("BJ2028E"));
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateReportColumn(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
-{
-	AmsInt iColumnNumber = AmsStrToInteger(padtParameterGroup->GetColumnNumber())
-
-		if(madtColumnParameters.find(iColumnNumber) != madtColumnParameters.end())
-		{
-			//Parameters already defined for report column %1
-			AddProblem("BJ2032E") << strColumnNumber;
-		}
-
-	FfsERSystemAssuranceDefinitionColumnPtr padtColumn = padtParameterGroup->GetColumnObj();
-
-		if(padtColumn)
-		{
-		if(padtParameterGroup->GetGroupName() != padtColumn.GetReportType.GetValue())
-			{
-				//BJ2035E Column Number %1 entered for Report Type %2 does not match a column 
-				//number defined in ER System Assurance Definition %3 for the matching Report Type
-			ReportProblem(AmsProblem("BJ2035E") << padtParameterGroup->GetColumnNumber() << padtParameterGroup->GetGroupName()
-				<< mstrERSystemAssuranceCode);
-			}
-
-		AmsString strColumnReportCode = padtColumn->GetReportDefintionByType(padtParameterGroup->GetGroupName());
-
-		if(!strColumnReportCode.isNull() && padtParameterGroup->GetReportCode() != strColumnReportCode)
-			{
-				//BJ2033E Report Code %1 entered for Batch Group %2 does not match the Report 
-				//Code defined in ER System Assurance Definition %3 for Column %4
-			ReportProblem(AmsProblem("BJ2033E") << padtParameterGroup->GetReportCode() << padtParameterGroup->GetGroupName()
-				<< mstrERSystemAssuranceCode << padtParameterGroup->GetColumnNumber());
-			}		
-		}
-		else
-		{
-			//BJ2035E Column Number %1 entered for Report Type %2 does not match a column 
-			//number defined in ER System Assurance Definition %3 for the matching Report Type
-		ReportProblem(AmsProblem("BJ2035E") << padtParameterGroup->GetColumnNumber() << padtParameterGroup->GetGroupName()
-			<< mstrERSystemAssuranceCode);
-		}
-}
-
-AmsBoolean
-FfsERSystemAssuranceProcessor::ValidateParameterGroup(FfsERSystemAssuranceParmeterGroupPtr padtParameterGroup)
-{
-	if(!padtParameterGroup->GetColumnNumber().isNull() || !padtParameterGroup->GetFiscalMonth().isNull() ||
-		!padtParameterGroup->GetFiscalQuarter().isNull() || !padtParameterGroup->GetFiscalYear().isNull() ||
-		!padtParameterGroup->GetReportCode().isNull() || !padtParameterGroup->GetReportVersion().isNull() ||
-		!padtParameterGroup->GetAgency().isNull()))
-	{
-		if(padtParameterGroup->GetColumnNumber().isNull()  || padtParameterGroup->GetFiscalYear().isNull())
-		{
-			if(padtParameterGroup->IsGLRollup())
-			{
-				if(padtParameterGroup->GetAgency().isNull())
-				{
-					//BJ2029E:  The following parameter values are required for the %1 group:  Agency, 
-					//Fiscal Year and ER System Assurance Column Number.
-					ReportProblem(AmsProblem("BJ2029E") << padtParameterGroup->GetGroupName());
-				}
-			}
-			else
-			{
-				if(padtParameterGroup->GetReportCode().isNull() || padtParameterGroup->GetReportVersion().isNull())
-				{
-					//BJ2034E:  The following parameter values are required for the %1 group:  Report Code, 
-					//Fiscal Year, Report Version and ER System Assurance Column Number.
-					ReportProblem(AmsProblem("BJ2034E") << padtParameterGroup->GetGroupName());
-				}
-			}
-		}
-
-		if(!padtParameterGroup->GetFiscalQuarter().isNull() && !padtParameterGroup->GetFiscalMonth().isNull())
-		{
-			//BJ0351E:  The Fiscal Quarter and Fiscal Month cannot both be specified.
-			ReportProblem(AmsProblem("BJ0351E"));
-		}
-
-		mbComplexParameterEntered = TRUE;
-	}
-	else
-	{
-		delete padtParameterGroup;
-		return FALSE;
-	}
-
-	return TRUE;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateReportParameters(const AmsString& strGroupName, AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
-{
-	AmsInt iParamGroupCount = NumberOfParameterGroups(strGroupName);
-
-	for (AmsInt iGroupNumber = 0; iGroupNumber < iParamGroupCount; iGroupNumber++) 
-	{
-		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = PopulateParameterGroup(strGroupName, iGroupNumber, adtFactory, adtDetailFactory);
-		ValidateReportColumn(padtParameterGroup);
-
-		if(ValidateParameterGroup(padtParameterGroup))
-		{
-			CheckReportExistence(padtParameterGroup, adtFactory);
-		}
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateFactsReportParameters(const AmsString& strGroupName, AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
-{
-	AmsInt iParamGroupCount = NumberOfParameterGroups(strGroupName);
-	for (AmsInt iGroupNumber = 0; iGroupNumber < iParamGroupCount; iGroupNumber++) 
-	{
-		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = PopulateParameterGroup(strGroupName, iGroupNumber, adtFactory, adtDetailFactory);
-		ValidateReportColumn(padtParameterGroup);
-
-		if(ValidateParameterGroup(padtParameterGroup))
-		{
-			CheckFactsReportExistence(padtParameterGroup, adtFactory);
-		}
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateGLRollupParameters(const AmsString& strGroupName, AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
-{
-	AmsInt iParamGroupCount = NumberOfParameterGroups(strGroupName);
-	for (AmsInt iGroupNumber = 0; iGroupNumber < iParamGroupCount; iGroupNumber++) 
-	{
-		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = PopulateGLParameterGroup(strGroupName, iGroupNumber, adtFactory, adtDetailFactory);
-		ValidateReportColumn(padtParameterGroup);
-
-		if(ValidateParameterGroup(padtParameterGroup))
-		{
-			madtColumnParameters[AmsStrToULong(padtParameterGroup->GetColumnNumber())] = padtParameterGroup;
-		}
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateBalanceSheet()
-{
-	ValidateReportParameters(FfsERSystemAssuranceDefinition::BALANCE_SHEET, GetPOFactory(FfsFormAndContentBalanceSheetReport),
-		GetPOFactory(FfsFormAndContentBalanceSheetReportCell));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateBudgetaryResources()
-{
-	ValidateReportParameters(FfsERSystemAssuranceDefinition::BUDGETARY_RESOURCES, GetPOFactory(FfsFormAndContentBudgetaryResourcesReport),
-		GetPOFactory(FfsFormAndContentBudgetaryResourcesReportCell));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateChangesInNetPosition()
-{
-	ValidateReportParameters(FfsERSystemAssuranceDefinition::CHANGES_IN_NET_POSITION, GetPOFactory(FfsFormAndContentChangesInNetPositionReport),
-		GetPOFactory(FfsFormAndContentChangesInNetPositionReportCell));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateCustodialActivity()
-{
-	ValidateReportParameters(FfsERSystemAssuranceDefinition::CUSTODIAL_ACTIVITY, GetPOFactory(FfsFormAndContentCustodialActivityReport),
-		GetPOFactory(FfsFormAndContentCustodialActivityReportCell));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateFinancing()
-{
-	ValidateReportParameters(FfsERSystemAssuranceDefinition::FINANCING, GetPOFactory(FfsFormAndContentFinancingReport), 
-		GetPOFactory(FfsFormAndContentFinancingReportCell));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateNetCost()
-{
-	ValidateReportParameters(FfsERSystemAssuranceDefinition::NET_COST, GetPOFactory(FfsFormAndContentNetCostReport),
-		GetPOFactory(FfsFormAndContentNetCostReportCell));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateSF133()
-{
-	ValidateReportParameters(FfsERSystemAssuranceDefinition::SF133, GetPOFactory(FfsExternalReport133Report),
-		GetPOFactory(FfsExternalReport133ReportCell));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateFacts1Adjusted()
-{
-	ValidateFactsReportParameters(FfsERSystemAssuranceDefinition::FACTS_I_ADJUSTED, GetPOFactory(FfsFacts1AdjustedTrialBalanceReport),
-		GetPOFactory(FfsFacts1AdjustedTrialBalanceReportDetail));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateFacts1Preliminary()
-{
-	ValidateFactsReportParameters(FfsERSystemAssuranceDefinition::FACTS_I_PRELIMINARY, GetPOFactory(FfsFacts1PreliminaryTrialBalanceReport),
-		GetPOFactory(FfsFacts1PreliminaryTrialBalanceReportDetail));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateFacts2Adjusted()
-{
-	ValidateFactsReportParameters(FfsERSystemAssuranceDefinition::FACTS_II_ADJUSTED, GetPOFactory(FfsFacts2AdjustedTrialBalanceReport),
-		GetPOFactory(FfsFacts2AdjustedTrialBalanceReportDetail));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateFacts2Preliminary()
-{
-	ValidateFactsReportParameters(FfsERSystemAssuranceDefinition::FACTS_II_PRELIMINARY, GetPOFactory(FfsFacts2PreliminaryTrialBalanceReport),
-		GetPOFactory(FfsFacts2PreliminaryTrialBalanceReportDetail));
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ValidateGLRollup()
-{
-	// initially assume that we will need the factory with the lowest level of detail
-	// we will recalculate this to use the most efficient factory later
-	ValidateGLRollupParameters(FfsERSystemAssuranceDefinition::GL_ROLLUP, GetPOFactory(FfsGLAcctAnnualBalByVendor), GetPOFactory(FfsGLAcctAnnualBalByVendor));
-}
-
-FfsERSystemAssuranceParameterGroupPtr
-FfsERSystemAssuranceProcessor::PopulateBasicParameterGroup(const AmsString& strGroupName, const AmsInt& iGroupNumber, 
-														   AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
-{
-	FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = new FfsERSystemAssuranceParameterGroup;
-	padtParameterGroup->SetGroupName(strGroupName);
-	padtParameterGroup->SetFactory(&adtFactory);
-	padtParameterGroup->SetDetailFactory(&adtDetailFactory);
-	padtParameterGroup->SetColumnNumber(GetAndReportParameter("erSystemAssuranceColumnNumber" , strGroupName, iGroupNumber));
-	padtParameterGroup->SetFiscalMonth(GetAndReportParameter("fiscalMonth", strGroupName, iGroupNumber));
-	padtParameterGroup->SetFiscalQuarter(GetAndReportParameter("fiscalQuarter", strGroupName, iGroupNumber));
-	padtParameterGroup->SetFiscalYear(GetAndReportParameter("fiscalYear", strGroupName, iGroupNumber));
-
-    FfsERsystemAssuranceDefinitionColumnPtr padtColumn = madtERSystemAssuranceDefinition->GetColumn(padtParameterGroup->GetColumnNumber());
-    padtParameterGroup->SetColumnId(padtColumn->GetIdentityAspect());
-
-	return padtParameterGroup;
-}
-
-FfsERSystemAssuranceParameterGroupPtr
-FfsERSystemAssuranceProcessor::PopulateParameterGroup(const AmsString& strGroupName, const AmsInt& iGroupNumber, 
-													  AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
-{
-	FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = PopulateBasicParameterGroup(strGroupName, iGroupNumber, adtFactory, adtDetailFactory);
-	padtParameterGroup->SetReportCode(GetAndReportParameter("reportCode", strGroupName, iGroupNumber));
-	padtParameterGroup->SetReportVersion(GetAndReportParameter("reportVersion", strGroupName, iGroupNumber));
-	return padtParameterGroup;
-}
-
-FfsERSystemAssuranceParameterGroupPtr
-FfsERSystemAssuranceProcessor::PopulateGLParameterGroup(const AmsString& strGroupName, const AmsInt& iGroupNumber, AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
-{
-	FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = PopulateBasicParameterGroup(strGroupName, iGroupNumber, adtFactory, adtDetailFactory);
-	padtParameterGroup->SetAgency(GetAndReportParameter("agency", strGroupName, iGroupNumber));
-	return padtParameterGroup;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::CheckReportExistence(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsBaseFactory& adtFactory)
-{
-	FfsExternalReportAbstractReportPtr padtSelect = (FfsExternalReportAbstractReportPtr)adtFactory.SelectCriteriaAb();
-	padtSelect->SetCode(padtParameterGroup->GetReportCode());
-	padtSelect->SetVersion(padtParameterGroup->GetReportVersion());
-	padtSelect->SetReportingMonth(padtParameterGroup->GetFiscalMonth());
-	padtSelect->SetReportingQuarter(padtParameterGroup->GetFiscalQuarter());
-	padtSelect->SetReportingYear(padtParameterGroup->GetFiscalYear());
-
-	deque<FfsExternalReportAbstractReportPtr>* padtReportDeque =
-		(deque<FfsExternalReportAbstractReportPtr>*)adtFactory.SelectAllWhereAb(padtSelect);
-
-	delete padtSelect;
-
-	if(!padtReportDeque->size())
-	{
-		//BJ2026E The Report Version for Report Type %1 does not exist, 
-		//therefore no Query Records were created for %2 
-		ReportProblem(AmsProblem("BJ2026E") << padtParameterGroup->GetGroupName() << mstrERSystemAssuranceCode);
-		delete padtParameterGroup;
-	}
-	else
-	{
-		padtParameterGroup->SetReportId((*padtReportDeque)[0]->GetIdentityValue());
-		madtColumnParameters[AmsStrToULong(padtParameterGroup->GetColumnNumber())] = padtParameterGroup;
-	}
-
-	release(padtReportDeque->begin(), padtReportDeque->end());
-	delete padtReportDeque;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::CheckFactsReportExistence(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsBaseFactory& adtFactory)
-{
-	FfsFactsAbstractReportPtr padtSelect = (FfsFactsAbstractReportPtr)adtFactory.SelectCriteriaAb();
-	padtSelect->SetCode(padtParameterGroup->GetReportCode());
-	padtSelect->SetVersion(padtParameterGroup->GetReportVersion());
-	padtSelect->SetReportingMonth(padtParameterGroup->GetFiscalMonth());
-	padtSelect->SetReportingQuarter(padtParameterGroup->GetFiscalQuarter());
-	padtSelect->SetReportingYear(padtParameterGroup->GetFiscalYear());
-
-	deque<FfsFactsAbstractReportPtr>* padtReportDeque = (deque<FfsFactsAbstractReportPtr>*)adtFactory.SelectAllWhereAb(padtSelect);
-
-	delete padtSelect;
-
-	if(!padtReportDeque->size())
-	{
-		//BJ2026E The Report Version for Report Type %1 does not exist, 
-		//therefore no Query Records were created for %2 
-		ReportProblem(AmsProblem("BJ2026E") << padtParameterGroup->GetGroupName() << mstrERSystemAssuranceCode);
-		delete padtParameterGroup;
-	}
-	else
-	{
-		padtParameterGroup->SetReportId((*padtReportDeque)[0]->GetIdentityValue());
-		madtColumnParameters[AmsStrToULong(padtParameterGroup->GetColumnNumber())] = padtParameterGroup;
-	}
-
-	release(padtReportDeque->begin(), padtReportDeque->end());
-	delete padtReportDeque;
-}
-
-AmsULong
-FfsERSystemAssuranceProcessor::GenerateVersionNumber()
-{
-	AmsULong ulVersion;
-
-	FfsERSystemAssuranceReportPtr padtCriteria = (FfsERSystemAssuranceReportPtr)(GetFactory().SelectCriteriaAb());
-	padtCriteria->SetCode(mstrERSystemAssuranceCode);
-
-	AmsDBSelector adtSelector;
-	GetFactory().GetStorage()->SelectAllWhere(adtSelector, padtCriteria);
-
-	AmsPartialQueryInfoPtr padtPartialQueryInfo = new AmsPartialQueryInfo;
-	AmsInt iAspect = GetFactory().GetStorage()->GetColumnIndexForPartialSelect("version");
-	padtPartialQueryInfo->SetQueryAspect(iAspect, AmsSQLHelper::MAX);
-
-	AmsReaderPtr padtReader = GetFactory().GetPartialReaderWhere(adtSelector, padtPartialQueryInfo);
-
-	if(padtReader->NextRow())
-	{
-		FfsERSystemAssuranceReportPtr padtResult = (FfsERSystemAssuranceReportPtr)(GetFactory().CreateSingleInstanceAb(padtReader));
-		ulVersion = padtResult->GetVersion().GetValue() + 1;
-		delete padtResult;
-	}
-	else
-		ulVersion = 1;
-
-	delete padtCriteria;
-	delete padtPartialQueryInfo;
-}
-
-FfsERSystemAssuranceDefinitionPtr 
-FfsERSystemAssuranceProcessor::GetERSystemAssuranceDefinition()
-{
-	FfsERSystemAssuranceDefinition madtERSystemAssuranceRef;
-	madtERSystemAssuranceRef.SetCodeAspect(mstrERSystemAssuranceCode);
-	madtERSystemAssuranceRef.AsIdentity();
-	return madtERSystemAssuranceRef.GetERSystemAssuranceObj();
-}
-
-AmsString
-FfsERSystemAssuranceProcessor::GetAndReportParameter(const AmsString& strParameterName, const AmsString& strGroupName, const AmsInt iGroup)
-{
-	AmsString strReturn = GetParameterValue( strParameterName, strGroupName, iGroup );
-	ReportParameterValue(strGroupName, strParameterName, strReturn, iGroup);
-	return strReturn; 
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::Process()
-{
-	FfsERSystemAssuranceReportPtr padtNewReport = GetPOFactory(FfsERSystemAssuranceReport).NewInstance();
-	PopulateReportHeader(padtNewReport);
-	PopulateReportParameters(padtNewReport);
-
-	for(AmsInt i = 0; i < madtERSystemAssuranceDefinition->LineCount(); i++
-	{
-		FfsERSystemAssuranceDefinitionLinePtr padtLine =
-			(FfsERSystemAssuranceDefinitionLinePtr) madtERSystemAssuranceDefinition->GetLine(i);
-
-		if(padtLine->GetAmountsLiteralIndicator().GetValue() == FfsExternalReportAbstractDefinitionLine::AMOUNT)
-		{
-			map<AmsInt, AmsReaderPtr, less<AmsInt>>* padtReaderMap = GetReadersMap(padtLine);
-
-			ProcessLine(padtReaderMap, padtNewReport, padtLine);
-			release(padtReaderMap);
-			delete padtReaderMap;
-		}
-        else
-            CreateTotalsLine(padtNewReport, padtLine);
-	}
-
-	padtNewReport->RoundAmounts(madtERSystemAssuranceDefinition);
-
-	// massage data if display discrepancies only is selected
-	HandleDisplayDiscrepancies(padtNewReport);
-	padtNewReport->Save();
-	delete padtNewReport;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ProcessLine(map<AmsInt, AmsReaderPtr, less<AmsInt>>* padtReaderMap, 
-										   FfsERSystemAssuranceReportPtr padtNewReport, FfsERSystemAssuranceDefinitionLinePtr padtLine)
-{
-	map<AmsInt, FfsERSystemAssuranceReportActivityPtr, less<AmsInt>> adtCells;
-
-	// This method will walk through the reader map and look for a corresponding object in the adtCellsMap.
-	// If none is found for the reader, it will read the next object from the reader and check to see if it matches criteria.
-	// If so, it adds it to the cells map.  If not, it continues reading until it finds an eligible cell or runs out of rows.
-	ReadNextCell(&adtCells, padtReaderMap, padtLine->GetLineNumber().GetValue());
-
-	FfsERSystemAssuranceReportLinePtr padtReportLine = CreateNewReportLine(padtNewReport, padtLine);
-	FfsERSystemAssuranceReportLineDetailPtr padtReportLineDetail = NULL;
-
-	while(adtCells.size()) // there is at least one more cell to process
-	{
-		// Find next cell will return the cell with the lowest key values for the cell criteria.
-		// It will also pull that cell out of the map. which means we own it and need to clean it up
-		FfsERSystemAssuranceReportCellDetailPtr padtCell = FindNextCell(&adtCells);
-
-		if(!padtReportLineDetail || !ReportLineMatchesCell(padtReportLineDetail, padtCell))
-		{
-			if(padtReportLineDetail)
-			{
-				padtReportLineDetail->Save();
-				delete padtReportLineDetail;
-				padtReportLineDetail = NULL;
-			}
-
-			padtReportLineDetail = CreateNewReportLineDetail(padtReportLine, padtCell);
-		}
-
-			padtReportLine->AddColumnAmount(padtCell->GetColumnNumber(), padtCell->GetAmount());
-			padtReportLineDetail->AddColumnAmount(padtCell->GetColumnNumber(), padtCell->GetAmount());
-			
-		// This will add the link record needed for the drill down queries.
-			AddLinkRecord(padtCell, padtReportLineDetail);
-
-      	// Cleanup
-      	delete padtCell;
-      	padtCell = NULL;
-
-		ReadNextCell(&adtCells, padtReaderMap, padtLine->GetLineNumber().GetValue());
-	}
-
-	//Save the last one
-	if(padtReportLineDetail)
-	{
-		padtReportLineDetail->Save();
-		delete padtReportLineDetail;
-		padtReportLineDetail = NULL;
-	}
-
-	if(padtReportLine)
-	{
-		padtReport->AddLine(padtLine);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::PopulateReportHeader(FfsERSystemAssuranceReportPtr padtReport)
-{
-	padtReport->SetReportCode(madtERSystemAssuranceDefinition->GetCode().GetValue());
-	padtReport->SetSecurityOrganizationId(madtERSystemAssuranceDefinition->GetSecurityOrganizationId().GetValue();
-	padtReport->SetDisplayDiscrepanciesOnly(mbDisplayDiscrepanciesOnlyFlag);
-	padtReport->SetVersion(GenerateVersionNumber());
-	padtReport->SetCreationDate(AmsDate::now());
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::PopulateReportParameters(FfsERSystemAssuranceReportPtr padtReport)
-{
-	for(AmsInt i = 0; i < madtColumnParameters->Size(); i++)
-	{
-		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = (*madtColumnParameters)[i];
-
-		FfsERSystemAssuranceReportParameterInformationPtr padtNewParameterInformation = 
-			GetPOFactory(FfsERSystemAssuranceReportParameterInformation).NewInstance();
-		padtNewParameterInformation->SetParentERSystemAssuranceReportId(padtReport->GetIdentityAspect().GetValue());
-		padtNewParameterInformation->SetReportType(padtParameterGroup->GetGroupName());
-		padtNewParameterInformation->SetColumnNumber(padtParameterGroup->GetColumnNumber());
-		padtNewParameterInformation->SetReportCode(padtParameterGroup->GetReportCode());
-		padtNewParameterInformation->SetReportVersion(padtParameterGroup->GetReportVersion());
-		padtNewParameterInformation->SetFiscalYear(padtParameterGroup->GetFiscalYear());
-		padtNewParameterInformation->SetFiscalQuarter(padtParameterGroup->GetFiscalQuarter());
-		padtNewParameterInformation->SetFiscalMonth(padtParameterGroup->GetFiscalMonth());
-		padtNewParameterInformation->SetAgency(padtParameterGroup->GetAgencyId());
-	}
-}
-
-AmsBoolean
-FfsERSystemAssuranceProcessor::ReportLineMatchesCell(FfsERSystemAssuranceReportLineDetailPtr padtDetail, FfsERSystemAssuranceReportCellDetailPtr padtCell)
-{
-	return (padtDetail->GetTreasurySymbolId().GetValue() == padtCell->GetTreasurySymbolId() && 
-	   padtDetail->GetFundId().GetValue() == padtCell->GetFundId() &&
-	   padtDetail->GetTradingPartnerId().GetValue() == padtCell->GetTradingPartnerId() &&
-	   padtDetail->GetFACTSIFundGroup().GetValue() == padtCell->GetFactsFundGroup() &&
-	   padtDetail->GetPartition().GetValue() == padtCell->GetPartition());
-}
-
-FfsERSystemAssuranceReportLinePtr
-FfsERSystemAssuranceProcessor::CreateNewReportLine(FfsERSystemAssuranceReportPtr padtReport, FfsERSystemAssuranceDefinitionLinePtr padtLine)
-{
-	FfsERSystemAssuranceReportLinePtr padtNewReportLine = GetPOFactory(FfsERSystemAssuranceReportLine).NewInstance();
-	padtNewReportLine->SetParentERSystemAssuranceReportId(padtReport->GetIdentityAspect().GetValue());
-	padtNewReportLine->SetLineNumber(padtLine->GetLineNumber().GetValue());
-
-	return padtNewReportLine;
-}
-
-FfsERSystemAssuranceReportLineDetailPtr
-FfsERSystemAssuranceProcessor::CreateNewReportLineDetail(FfsERSystemAssuranceReportLinePtr padtReportLine, FfsERSystemAssuranceReportCellDetailPtr padtCell)
-{
-	FfsERSystemAssuranceReportLineDetailPtr padtNewReportLineDetail = GetPOFactory(FfsERSystemAssuranceReportLine).NewInstance();
-	padtNewReportLineDetail->SetParentERSystemAssuranceReportLineId(padtReportLine->GetIdentityValue());
-	padtNewReportLineDetail->SetLineNumber(padtCell->GetLineNumber());
-
-	padtNewReportLineDetail->SetFund(padtCell->GetFund());
-	padtNewReportLineDetail->SetBBFY(padtCell->GetBBFY());
-	padtNewReportLineDetail->SetEBFY(padtCell->GetEBFY());
-	padtNewReportLineDetail->SetPartition(padtCell->GetPartition());
-	padtNewReportLineDetail->SetTreasurySymbol(padtCell->GetTreasurySymbol());
-	padtNewReportLineDetail->SetFACTSIFundGroup(padtCell->GetFactsFundGroup());
-	padtNewReportLineDetail->SetTradingParter(padtCell->GetTradingPartner());
-
-	return padtNewReportLineDetail;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddLinkRecord(FfsERSystemAssuranceReportCellDetailPtr padtCell, 
-											 FfsERSystemAssuranceReportLineDetailPtr padtLineDetail)
-{
-	FfsERSystemAssuranceReportActivityPtr padtNewReportActivity = GetPOFactory(FfsERSystemAssuranceReportActivity).NewInstance();
-	padtNewReportActivity->SetParentERSystemAssuranceReportLineDetailId(padtLineDetail->GetIdentityAspect().GetValue());
-	padtNewReportActivity->SetColumnNumber(padtCell->GetColumnNumber().GetValue());
-	padtNewReportActivity->SetReportLinkId(padtCell->GetLinkId().GetValue());
-
-	padtNewReportActivity->Save();
-	delete padtNewReportActivity;
-}
-
-AmsReaderPtr
-FfsERSystemAssuranceProcessor::GetReader(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, FfsERSystemAssuranceDefinitionCellPtr padtCell)
-{
-	if(padtParameterGroup->IsAbstractExternalReport())
-		return GetAbstractExternalReportReader(padtParameterGroup, padtLine, padtColumn, padtCell);
-	else if(padtParameterGroup->IsFactsAbstractExternalReport())
-		return GetFactsAbstractReportReader(padtParameterGroup, padtLine, padtColumn, padtCell);
-	else if(padtParameterGroup->IsGLRollup())
-		return GetGLRollupReader(padtParameterGroup, padtLine, padtColumn, padtCell);
-
-	return NULL;
-}
-
-map<AmsInt, AmsReaderPtr, less<AmsInt>>*
-FfsERSystemAssuranceProcessor::GetReadersMap(FfsERSystemAssuranceDefinitionLinePtr padtLine)
-{
-	map<AmsInt, AmsReaderPtr, less<AmsInt>>* padtReturn = new map<AmsInt, AmsReaderPtr, less<AmsInt>>;
-	map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>::iterator it = madtColumnParameters.begin();
-
-	for( ; it != madtColumnParameters.end(); it++)
-	{
-		FfsERSystemAssuranceParmeterGroupPtr padtParameterGroup = (*it).second;
-		FfsERSystemAssuranceDefinitionColumnPtr padtColumn =
-			madtERSystemAssuranceDefinition->GetColumn(AmsULongToStr((*it).first));
-		FfsERSystemAssuranceDefinitionCellPtr padtCell =
-			madtERSystemAssuranceDefinition->GetCell(padtLine->GetSectionNumber().GetValue(), padtLine->GetLineNumber().GetValue(), AmsULongToStr((*it).first));
-
-		if(padtCell && padtColumn)
-		{
-			(*padtReturn)[(*it).first] = GetReader(padtParameterGroup, padtLine, padtColumn, padtCell);
-		}
-	}
-
-	return padtReturn;
-}
-
-AmsReaderPtr
-FfsERSystemAssuranceProcessor::GetAbstractExternalReportReader(FfsERSystemAssuranceParmeterGroupPtr padtParameterGroup, FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, FfsERSystemAssuranceDefinitionCellPtr padtCell)
-{
-	AmsDBSelector adtSelector;
-	FfsExternalReportAbstractReportCellPtr padtSelect =
-		(FfsExternalReportAbstractReportCellPtr)padtParameterGroup->GetDetailFactory().SelectCriteriaAb();
-	padtSelect->SetParentIdentity(padtParameterGroup->GetReportId());
-	padtParameterGroup->GetDetailFactory().GetStorage()->SelectAllWhere(adtSelector, padtSelect);
-	delete padtSelect;
-
-	FfsExternalReportAbstractReportCellSQLPtr padtSQL = 
-		(FfsExternalReportAbstractReportCellSQLPtr)padtParameterGroup->GetDetailFactory().GetStorage();
-	AmsTableMapPtr padtTable = padtSQL->GetTables()->front();
-
-	AmsManyRelationPtr padtRelation = NULL;
-
-	// Add definition cell criteria
-	if(padtParameterGroup->IsFormAndContentReport())
-		padtRelation = padtCell->GetFormAndContentReportDefinitions();
-	else if(padtParameterGroup->IsSF133Report())
-      padtRelation = padtCell->GetExternalReportDefinitions();
-		
-	AddAbstractExternalReportCriteria(adtSelector, padtRelation, padtTable);
-
-	AmsReaderPtr padtReader = padtParameterGroup->GetDetailFactory().GetNewReaderWhere(adtSelector);
-	return padtReader;
-}
-
-AmsReaderPtr
-FfsERSystemAssuranceProcessor::GetGLRollupReader(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
-												 FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, 
-												 FfsERSystemAssuranceDefinitionCellPtr padtCell)
-{
-	// earlier we just assume FfsGLAcctAnnualBalByVendor as the factory
-	// now we will figure out what is the most efficient factory that we can use
-	DetermineGLFactory(padtParameterGroup, padtColumn, padtCell);
-	AmsDBSelector adtSelector = GetGLRollupReaderCriteria(padtParameterGroup, padtLine, padtColumn, padtCell);
-	AmsReaderPtr padtReader = padtParameterGroup->GetDetailFactory().GetNewReaderWhere(adtSelector);
-	return padtReader;
-}
-
-AmsDBSelector
-FfsERSystemAssuranceProcessor::GetGLRollupReaderCriteria(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
-														 FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, 
-														 FfsERSystemAssuranceDefinitionCellPtr padtCell)
-{
-	AmsDBSelector adtSelector;
-
-	FfsGLAcctBalancePtr padtSelect = (FfsGLAcctBalancePtr)padtParameterGroup->GetDetailFactory().SelectCriteriaAb();
-	FfsGLAcctBalanceSQLPtr padtSQL = (FfsGLAcctBalanceSQLPtr)padtParameterGroup->GetDetailFactory().GetStorage();
-	AmsTableMapPtr padtTable = padtSQL->GetTables()->front();
-
-	padtSelect->SetAgency(padtParameterGroup->GetAgency());
-	padtSelect->SetFiscalYear(padtParameterGroup->GetFiscalYear());
-
-	if(!padtParameterGroup->GetFiscalMonth().isNull())
-		padtSelect->SetFiscalMonth(padtParameterGroup->GetFiscalMonth());
-
-	padtSQL->SelectAllWhere(adtSelector, padtSelect);
-	delete padtSelect;
-
-	if(!padtParameterGroup->GetFiscalQuarter().isNull())
-	{
-		AmsDBSelector adtFiscalMonthSelector = GetFiscalMonthsByQuarterSelector(padtParameterGroup->GetFiscalYear(),
-			padtParameterGroup->GetFiscalQuarter());
-
-		adtSelector.where(adtSelector.where() && padtTable->GetTable()["FISC_MNTH"].in(adtFiscalMonthSelector));
-	}
-
-	// Add definition line criteria
-	AddGLFederalNonFederalCriteria(adtSelector, padtLine->GetFederalNonFederalIndicator().GetValue(), padtTable);
-	AddGLRollupGLAccountCriteria(adtSelector, padtParameterGroup, padtLine->GetGLAccounts(), padtTable);
-	AddTradingPartnerCriteria(adtSelector, padtParameterGroup, padtLine->GetTradingPartners(), padtTable);
-
-	// Add definition column criteria
-	AddTreasurySymbolCriteria(adtSelector, padtParameterGroup, padtColumn->GetTreasurySymbols(), padtTable);
-	AddPartitionCriteria(adtSelector, padtColumn->GetPartitions(), padtTable);
-	AddGLBureauCriteria(adtSelector, padtColumn->GetBureaus(), padtTable);
-	AddDimensionStripCriteria(adtSelector, padtColumn->GetAccountingDimensions(), padtTable);
-	AddGLFundSettingCriteria(adtSelector, padtColumn->GetFundSetting().GetValue(), padtTable);
-
-	if(padtParameterGroup->GetFactory().GetClassID() == GetPOFactory(FfsGLAcctPeriodicBalByDist).GetClassID() ||
-		padtParameterGroup->GetFactory().GetClassID() == GetPOFactory(FfsGLAcctPeriodicBalByFund).GetClassID())
-	{
-		AmsDBSelector adtClosingPeriodSelector = GetClosingPeriodSelector(padtParameterGroup->GetFiscalYear());
-		adtSelector.where(adtSelector.where() && !padtTable->GetTable()["FISC_MNTH"].in(adtClosingPeriodSelector));
-	}
-
-	// Add definition cell criteria
-	AddGLRollupGLAccountCriteria(adtSelector, padtParameterGroup, padtCell->GetGLAccounts(), padtTable);
-	AddTreasurySymbolCriteria(adtSelector, padtParameterGroup, padtCell->GetTreasurySymbols(), padtTable);
-	AddPartitionCriteria(adtSelector, padtCell->GetPartitions(), padtTable);
-	AddGLBureauCriteria(adtSelector, padtCell->GetBureaus(), padtTable);
-	AddDimensionStripCriteria(adtSelector, padtCell->GetAccountingDimensions(), padtTable);
-	AddTradingPartnerCriteria(adtSelector, padtParameterGroup, padtCell->GetTradingPartners(), padtTable);
-
-	return adtSelector;
-}
-
-AmsReaderPtr
-FfsERSystemAssuranceProcessor::GetFactsAbstractReportReader(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
-															FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, 
-															FfsERSystemAssuranceDefinitionCellPtr padtCell)
-{
-	AmsDBSelector adtSelector = GetFactsAbstractReportReaderCriteria(padtParameterGroup, padtLine, padtColumn, padtCell);
-	AmsReaderPtr padtReader = padtParameterGroup->GetDetailFactory().GetNewReaderWhere(adtSelector);
-	return padtReader;
-}
-
-AmsDBSelector
-FfsERSystemAssuranceProcessor::GetFactsAbstractReportReaderCriteria(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
-																	FfsERSystemAssuranceDefinitionLinePtr padtLine, 
-																	FfsERSystemAssuranceDefinitionColumnPtr padtColumn, 
-																	FfsERSystemAssuranceDefinitionCellPtr padtCell)
-{
-	AmsDBSelector adtSelector;
-	FfsFactsAbstractReportDetailPtr padtSelect = (FfsFactsAbstractReportDetailPtr)padtParameterGroup->GetDetailFactory().SelectCriteriaAb();
-	padtSelect->SetParentReportId(padtParameterGroup->GetReportId());
-	padtParameterGroup->GetDetailFactory().GetStorage()->SelectAllWhere(adtSelector, padtSelect);
-	delete padtSelect;
-
-	FfsFactsAbstractReportDetailSQLPtr padtSQL = (FfsFactsAbstractReportDetailSQLPtr)padtParameterGroup->GetDetailFactory().GetStorage();
-	AmsTableMapPtr padtTable = padtSQL->GetTables()->front();
-
-	// Add definition line criteria
-	AddFactsGLAccountCriteria(adtSelector, padtParameterGroup, padtLine->GetGLAccounts(), padtTable);
-	AddTradingPartnerCriteria(adtSelector, padtParameterGroup, padtLine->GetTradingPartners(), padtTable);
-	AddFactsFederalNonFederalCriteria(adtSelector, padtParameterGroup, padtLine->GetFederalNonFederalindicator().GetValue(), padtTable);
-
-	// Add definition column criteria
-	AddTreasurySymbolCriteria(adtSelector, padParameterGroup, padtColumn->GetTreasurySymbols(), padtTable);
-	AddFactsFundCriteria(adtSelector, padtParameterGroup, padtColumn->GetAccountingDimensions(), padtTable);
-
-	// Add definition cell criteria
-	AddTreasurySymbolCriteria(adtSelector, padtParameterGroup, padtCell->GetTreasurySymbols(), padtTable);
-	AddFactsFundCriteria(adtSelector, padtParameterGroup, padtCell->GetAccountingDimensions(), padtTable);
-	AddTradingPartnerCriteria(adtSelector, padtParameterGroup, padtCell->GetTradingPartners(), padtTable);
-	AddFactsGLAccountCriteria(adtSelector, padtParameterGroup, padtCell->GetGLAccounts(), padtTable)
-
-	return adtSelector;
-}
-
-AmsDBCriterion
-FfsERSystemAssuranceProcessor::GetGLAccountCriteria(const AmsString& strGLAccount, const AmsString& strGLRollupAccountBalance,
-													const AmsString& strGLUsage, AmsTableMapPtr padtTable, const AmsString& strGLACColumn, const AmsString& strSGLColumn,
-													FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
-{
-	AmsDBCriterion adtCriterion;
-	AmsString strFilterColumn = ( !strGLACColumn.isNull() ? strGLACColumn : strSGLColumn);
-	AmsBoolean bGLACId = (strGLACColumn != "GLAC");
-	AmsString strSubSelectColumn = ( bGLACId ? ( !strGLACColumn.isNull() ? "UIDY" : "STND_GL_ACCT_ID") : "CD");
-	AmsString strMonthColumn = "FISC_MNTH";
-
-	AmsDBSelector adtBeginningPeriodSelector = GetBeginningPeriodSelector(padtParameterGroup->GetFiscalYear());
-
-	if(strGLRollupAccountBalance == FfsExternalReportAbstractDefinitionCellGLAccount::BEGINNING)
-	{
-		adtCriterion = adtCriterion && (padtTable->GetTable()[strMonthColumn].in(adtBeginningPeriodSelector));
-	}
-	else if(strGLRollupAccountBalance == FfsExternalReportAbstractDefinitionCellGLAccount::CURRENT)
-	{
-		adtCriterion = adtCriterion && (!padtTable->GetTable()[strMonthColumn].in(adtBeginningPeriodSelector));
-	}
-
-	if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::STANDARD)
-	{
-		if(!strSGLColumn.isNull()) // We have a STND_GL_ACCT_ID column
-		{
-			adtCriterion = adtCriterion && (padtTable->GetTable()[strSGLColumn] == ConvertToGLAccountId(strGLAccount, padtParameterGroup));
-		}
-		else // No STND_GL_ACCT_ID column so we need to use GLAC/GLAC_ID column
-		{
-			adtCriterion = adtCriterion && (padtTable->GetTable()[strFilterColumn].in(
-				GetGLSelector(strSubSelectColumn, "STND_GL_ACCT_ID", ConvertToGLAccountId(strGLAccount, padtParameterGroup))));
-		}
-	}
-	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::CODED)
-	{
-		if(!strGLACColumn.isNull()) // We have a GLAC or GLAC_ID column
-		{
-			adtCriterion = adtCriterion && (padtTable->GetTable()[strGLACColumn] == ( bGLACId ? ConvertToGLAccountId(strGLAccount, padtParameterGroup) : strGLAccount) );
-		}
-		else // No GLAC_ID column so we need to use SGL_ACCT_ID
-		{
-			adtCriterion = adtCriterion && (padtTable->GetTable()[strSGLColumn].in( 
-				GetGLSelector("STND_GL_ACCT_ID", "UIDY", ConvertToGLAccountId(strGLAccount, padtParameterGroup))));
-		}
-	}
-	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::SUMMARY)
-	{
-		adtCriterion = adtCriterion && (padtTable->GetTable()[strFilterColumn].in( 
-			GetGLSelector(strSubSelectColumn, "SUMR_GLAC_ID", ConvertToGLAccountId(strGLAccount, padtParameterGroup))));
-	}
-	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::CATEGORY)
-	{
-		adtCriterion = adtCriterion && (padtTable->GetTable()[strFilterColumn].in( 
-			GetGLSelector( strSubSelectColumn, "ACTG_CAT_ID", strGLAccount, "FISC_YEAR", padtParameterGroup->GetFiscalYear())));
-	}
-	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::CLASS)
-	{
-		adtCriterion = adtCriterion && (padtTable->GetTable()[strFilterColumn].in( 
-			GetGLSelector( strSubSelectColumn, "ACTG_CLAS_ID", strGLAccount, "FISC_YEAR", padtParameterGroup->GetFiscalYear())));
-	}
-	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::GROUP)
-	{
-		adtCriterion = adtCriterion && (padtTable->GetTable()[strFilterColumn].in( 
-			GetGLSelector( strSubSelectColumn, "ACTG_GRP_ID", strGLAccount, "FISC_YEAR", padtParameterGroup->GetFiscalYear())));
-	}
-	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::TYPE)
-	{
-		adtCriterion = adtCriterion && (padtTable->GetTable()[strFilterColumn].in( 
-			GetGLSelector( strSubSelectColumn, "ACTG_TYP_ID", strGLAccount, "FISC_YEAR", padtParameterGroup->GetFiscalYear())));
-	}
-
-	return adtCriterion;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddGLFederalNonFederalCriteria(AmsDBSelector& adtSelector, 
-															  const AmsString& strFederalNonFederalIndicator, AmsTableMapPtr padtTable)
-{
-	if(!strFederalNonFederalIndicator.isNull())
-	{
-		if(strFederalNonFederalIndicator == FEDERAL)
-		{ 
-			adtSelector.where(adtSelector.where() && (padtTable->GetTable()["TRDG_PTNR_TYP"] == "F" ||
-				padtTable->GetTable()["FCT1_FDRL_IN"] == "F"));
-		}
-		else
-		{
-			// Translate non federal to X/E for Trading Partner Type and N for Facts I Federal Indicator
-			adtSelector.where(adtSelector.where() && (padtTable->GetTable()["TRDG_PTNR_TYP"] == "E" ||
-				padtTable->GetTable()["TRDG_PTNR_TYP"] == "X" || padtTable->GetTable()["FCT1_FDRL_IN"] == "N"));
-		}
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddGLTransferTSYMCriteria(AmsDBSelector& adtSelector, 
-														 FfsExternalReportAbstractDefinitionCellTradingPartnerPtr padtTradingPartner, AmsTableMapPtr padtTable)
-{
-	deque<AmsString> adtIncludeDeque;
-	deque<AmsString> adtExcludeDeque;
-
-    AmsDBCriterion adtCriterion;
-    adtCriterion = padtTable->GetTable()["TRDG_PTNR"].isNull();
-    adtSelector.where(adtSelector.where() || adtCriterion);
-    AmsBoolean bInclude = padtTradingPartner->GetIncludeExcludeIndicator().GetValue();
-
-    AmsDBSelector adtTSYMSelector;
-    FfsTreasurySymbolSQLPtr padtTreasurySymbolSQL = (FfsTreasurySymbolSQLPtr).GetPOFactory(FfsTreasurySymbol).GetStorage();
-    AmsDBTable adtTreasurySymbolTable = padtTreasurySymbolSQL->GetTables()->front()->GetTable();
-    adtTSYMSelector << adtTreasurySymbolTable["UIDY"];
-    adtTSYMSelector.where(adtSelector.where() && (adtTreasurySymbolTable["S133_AGCY_ID"] = padtTradingPartner->GetTradingPartnerId().GetValue() || 
-       adtTreasurySymbolTable["SRCE_AGCY_ID"] == padtTradingPartner->GetTradingPartnerId().GetValue()));
-    AmsReaderPtr padtReader = (FfsTreasurySymbolPtr)GetPOFactory(FfsTreasurySymbol).GetNewReaderWhere(adtSelector);
-
-    if(padtReader)
-    {
-        while(padtReader->NextRow())
-        {
-           AmsString strIdentity;
-           (*padtReader) >> strIdentity;
-
-           if(bInclude)
-              adtIncludeDeque.push_back(strIdentity);
-	else
-              adtExcludeDeque.push_back(strIdentity);
-        }
-    }
-
-	AddCriterionToSelector(adtSelector, padtTable->GetTable()["TRFR_TSYM_ID"],
-		adtIncludeDeque, adtExcludeDeque);
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddPartitionCriteria(AmsDBSelector& adtSelector,
-													AmsManyRelationPtr padtPartitions, AmsTableMapPtr padtTable)
-{
-	if(padtPartitions->Size())
-	{
-		deque<AmsString> adtIncludeDeque;
-		deque<AmsString> adtExcludeDeque;
-
-		for(AmsInt i = 0; i < padtPartitions->Size(); i++)
-		{
-			FfsExternalReportAbstractDefinitionPartitionPtr padtPartition = (*padtPartitions)[i];
-
-			adtIncludeDeque.push_back(padtPartition->GetPartition().GetValue());
-		}
-
-		AddCriterionToSelector(adtSelector, padtTable->GetTable()["PATN"], adtIncludeDeque, adtExcludeDeque);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddGLBureauCriteria(AmsDBSelector& adtSelector, 
-												   AmsManyRelationPtr padtBureaus, AmsTableMapPtr padtTable)
-{
-
-	if(padtBureaus->Size())
-	{
-		deque<AmsDBCriterion> adtIncludeDeque;
-		deque<AmsDBCriterion> adtExcludeDeque;
-
-		for(AmsInt i = 0; i < padtBureaus->Size(); i++
-		{
-			FfsExternalReportAbstractDefinitionBureauPtr padtBureau = (*padtBureaus)[i];
-			AddFundBureauCriterion(padtBureau->GetBureauId().GetValue(), adtIncludeDeque, TRUE, padtTable);
-		}
-
-		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddDimensionStripCriteria(AmsDBSelector& adtSelector
-														 AmsManyRelationPtr padtDimensionStrips, AmsTableMapPtr padtTable)
-{
-	if(padtDimensionStrips->Size())
-	{
-		deque<AmsCriterion> adtIncludeDeque;
-		deque<AmsCriterion> adtExcludeDeque;
-
-		for(AmsInt i = 0; i < padtDimensionStrips->Size(); i++)
-		{
-			FfsExternalReportAbstractDefinitionDimensionStripPtr padtDimStrip = (*padtDimensionStrips)[i];
-
-			if(padtDimStrip->GetIncludeExcludeIndicator().GetValue() == FfsExternalReportAbstractDefinitionCell::INCLUDE)
-				AddDimensionStripCriterion(padtDimStrip, adtIncludeDeque, TRUE, padtTable);
-			else
-				AddDimensionStripCriterion(padtDimStrip, adtExcludeDeque, FALSE, padtTable);
-		}
-
-		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddGLFactsAttributeCriteria(AmsDBCriterion & adtCriterion, 
-														   AmsManyRelationPtr padtFacts1Attributes, AmsManyRelationPtr padtFacts2Attributes,
-														   AmsTableMapPtr padtTable, const AmsBoolean& bInclude)
-{
-	if(padtFacts1Attributes->Size())
-	{
-		AmsDBCriterion adtAttributeCriterion;
-
-		for(AmsInt i = 0; i < padtFacts1Attributes->Size(); i++)
-		{
-
-			FFSERSystemAssuranceDefinitionCellGLFACTSPtr padtGLFacts1 = padtGLAccount->GetFacts1Attribute(i);
-
-			FfsFACTSAttributeDefinitionReference adtAttrRef;
-			adtAttrRef.SetAttributeNumber( padtGLFacts1->GetAttributeNumber().GetValue());
-			adtAttrRef.SetFiscalYear( padtParameterGroup->GetFiscalYear() );
-
-			FfsFACTSAttributeDefinitionPtr padtAttribute = (FfsFACTSAttributeDefinitionPtr) adtAttrRef.GetAttributeDefinitionObj();
-
-			if(padtAttribute->GetFederalNonFederalFlag().GetValue())
-			{
-				AddToSubCriterion(adtAttributeCriterion, padtTable->GetTable()["FCT1_FDRL_IN"], padtGLFacts1->GetDomainValue().GetValue(), bInclude);
-			}
-		}
-
-		if(bInclude)
-			adtCriterion = adtCriterion && (adtAttributeCriterion);
-		else
-			adtCriterion = adtCriterion || (adtAttributeCriterion);
-	}
-
-	if(padtFacts2Attributes->Size())
-	{
-		AmsDBCriterion adtAttributeCriterion;
-
-		for(AmsInt i = 0; i < padtFacts2Attributes->Size(); i++)
-		{
-			FFSERSystemAssuranceDefinitionCellGLFACTS2Ptr padtGLFacts2 = padtGLAccount.GetFacts2Attribute(i);
-
-			FfsFACTS2AttributeDefinitionReference adtAttrRef;
-			adtAttrRef.SetAttributeNumber( padtGLFacts2->GetAttributeNumber().GetValue());
-			adtAttrRef.SetFiscalYear( padtParameterGroup->GetFiscalYear() );
-
-			FfsFACTS2AttributeDefinitionPtr padtAttribute = (FfsFACTS2AttributeDefinitionPtr) adtAttrRef.GetAttributeDefinitionObj();
-
-			if(padtAttribute->GetYBAFlag().GetValue()
-			{
-               if(padtGLFacts2->GetDomainValue().GetValue() == FfsERSystemAssuranceProcessor::NEW)
-				{
-					if(bInclude)
-						adtAttributeCriterion = adtAttributeCriterion && padtTable->GetTable()["YBA"] >= padtParameterGroup->GetFiscalYear();
-					else
-						adtAttributeCriterion = adtAttributeCriterion || padtTable->GetTable()["YBA"] < padtParameterGroup->GetFiscalYear();
-				}
-               else if (padtGLFacts2->GetDomainValue().GetValue() == FfsERSystemAssuranceProcessor::BAL)
-				{
-					if(bInclude)
-						adtAttributeCriterion = adtAttributeCriterion && padtTable->GetTable()["YBA"] < padtParameterGroup->GetFiscalYear();
-					else
-						adtAttributeCriterion = adtAttributeCriterion || padtTable->GetTable()["YBA"] >= padtParameterGroup->GetFiscalYear();
-				}
-			}
-
-			if(padtAttribute->GetTransactionPartnerFlag().GetValue())
-			{
-				AddToSubCriterion(adtAttributeCriterion, padtTable->GetTable()["TRDG_PTNR_TYP"], padtGLFacts2->GetDomainValue().GetValue(), bInclude);
-			}
-
-			if(padtAttribute->GetPriorYearAdjustmentsFlag().GetValue())
-			{
-				AddToSubCriterion(adtAttributeCriterion, padtTable->GetTable()["PRYR_ADJM"], padtGLFacts2->GetDomainValue().GetValue(), bInclude);
-			}
-
-			if(padtAttribute->GetProgramReportingCategoryFlag())
-			{
-				AddToSubCriterion(adtAttributeCriterion, padtTable->GetTable()["PRC"], padtGLFacts2->GetDomainValue().GetValue(), bInclude);
-			}
-
-			if(padtAttribute->GetPublicLawFlag().GetValue())
-			{
-				AddToSubCriterion(adtAttributeCriterion, padtTable->GetTable()["PBLC_LAW_NUM"], padtGLFacts2->GetDomainValue().GetValue(), bInclude);
-			}
-		}
-
-		if(bInclude)
-			adtCriterion = adtCriterion && (adtAttributeCriterion);
-		else
-			adtCriterion = adtCriterion || (adtAttributeCriterion);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddToSubCriterion(AmsDBCriterion& adtCriterion, AmsDBColumn& adtColumn, const AmsString& strValue, const AmsBoolean& bInclude)
-{
-	if(bInclude)
-		adtCriterion = adtCriterion || adtColumn == strValue;
-	else
-		adtCriterion = adtCriterion && adtColumn != strValue;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddToCriterion(AmsDBCriterion& adtCriterion, AmsDBColumn& adtColumn, const AmsString& strValue, const AmsBoolean& bInclude)
-{
-	if(bInclude)
-		adtCriterion = adtCriterion && adtColumn == strValue;
-	else
-		adtCriterion = adtCriterion || adtColumn != strValue;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddGLFundSettingCriteria(AmsDBSelector& adtSelector, 
-														const AmsString& strFundSetting, AmsTableMapPtr padtTable)
-{
-	deque<AmsDBCriterion> adtIncludeDeque;
-	deque<AmsDBCriterion> adtExcludeDeque;
-
-	if(strFundSetting == FfsERSystemAssuranceDefinitionColumn::FACTS1) 
-		AddFundFactsInclusionCriterion("T", "F", adtIncludeDeque, TRUE, padtTable);
-	else if(strFundSetting == FfsERSystemAssuranceDefinitionColumn::FACTS2)
-		AddFundFactsInclusionCriterion("F", "T", adtIncludeDeque, TRUE, padtTable);
-	else if(strFundSetting == FfsERSystemAssuranceDefinitionColumn::FACTS1_FACTS2)
-		AddFundFactsInclusionCriterion("T", "T", adtIncludeDeque, TRUE, padtTable);
-
-	AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddGLRollupGLAccountCriteria(AmsDBSelector& adtSelector, 
-															FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsManyRelationPtr padtGLAccounts, AmsTableMapPtr padtTable)
-{
-	if(padtGLAccounts->Size())
-	{
-		AmsString strGLACColumn = "GLAC";
-		deque<AmsDBCriterion> adtIncludeDeque;
-		deque<AmsDBCriterion> adtExcludeDeque;
-
-		for(AmsInt i = 0; i < padtGLAccounts->Size(); i++)
-		{
-			// Create GL account criteria
-			FfsERSystemAssuranceDefinitionCellGLAccountPtr padtGLAccount = (*padtGLAccounts)[i];
-			AmsBoolean bInclude = padtGLAccount->GetIncludeExcludeIndicator().GetValue();
-			AmsString strGLAccountCriteria = padtGLAccount->GetGLAccountCriteriaByUsage();
-			AmsDBCriterion adtCriterion = GetGLAccountCriteria(strGLAccountCriteria, "", padtGLAccount->GetGLUsageIndicator.GetValue(),
-				padtTable, strGLACColumn, "", padtParameterGroup);
-
-			if(!bInclude)
-				adtCriterion = !(adtCriterion);
-
-			// Add facts attribute criteria
-			AddGLFactsAttributeCriteria(adtCriterion, padtGLAccount->GetFacts1Attributes(), padtGLAccount->GetFacts2Attributes(),
-				padtTable, bInclude);
-
-			AmsDBSelector adtBeginningPeriodSelector = GetBeginningPeriodSelector(padtParameterGroup->GetFiscalYear());
-
-			if(padtGLAccount->GetGLRollupAcctBalanceIndicator().GetValue() == FfsExternalReportAbstractDefinitionCellGLAccount::BEGINNING)
-			{
-				if(bInclude)
-				   adtCriterion = adtCriterion && (padtTable->GetTable()["FISC_MNTH"].in(adtBeginningPeriodSelector));
-                else
-                   adtCriterion = adtCriterion || !(padtTable->GetTable()["FISC_MNTH"].in(adtBeginningPeriodSelector));
-			}
-			else if(padtGLAccount->GetGLRollupAcctBalanceIndicator().GetValue() == FfsExternalReportAbstractDefinitionCellGLAccount::CURRENT)
-			{
-				if(bInclude)
-				adtCriterion = adtCriterion && !(padtTable->GetTable()["FISC_MNTH"].in(adtBeginningPeriodSelector));
-                else
-                   adtCriterion = adtCriterion || (padtTable->GetTable()["FISC_MNTH"].in(adtBeginningPeriodSelector));
-			}
-
-			// Add to the include/exclude criteria list
-			if(bInclude)
-				adtIncludeDeque.push_back(adtCriterion);
-			else
-				adtExcludeDeque.push_back(adtCriterion);
-		}
-
-		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddFactsGLAccountCriteria(AmsDBSelector& adtSelector, FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
-														 AmsManyRelationPtr padtGLAccounts, AmsTableMapPtr padtTable)
-{
-	if(padtGLAccounts->Size())
-	{
-		AmsString strGLACColumn = (padtParameterGroup->IsFactsPreliminaryReport() ? "GLAC_ID" : "");
-		AmsString strSGLColumn = "SGL_ACCT_ID";
-		deque<AmsDBCriterion> adtIncludeDeque;
-		deque<AmsDBCriterion> adtExcludeDeque;
-
-		for(AmsInt i = 0; i < padtGLAccounts->Size(); i++)
-		{
-			// Create GL account criteria
-			FfsERSystemAssuranceDefinitionCellGLAccountPtr padtGLAccount = (*padtGLAccounts)[i];
-			AmsBoolean bInclude = padtGLAccount->GetIncludeExcludeIndicator().GetValue();
-			AmsString strGLAccountCriteria = padtGLAccount->GetGLAccountCriteriaByUsage();
-			AmsDBCriterion adtCriterion = GetGLAccountCriteria(strGLAccountCriteria, "", padtGLAccount->GetGLUsageIndicator.GetValue(),
-				padtTable, strGLACColumn, strSGLColumn, padtParameterGroup);
-
-			if(!bInclude)
-				adtCriterion = !(adtCriterion);
-
-
-			// Add begin/end criteria
-			if(!padtGLAccount->GetFactsIIBeginEndIndicator().GetValue().isNull() && padtParameterGroup->IsFacts2Report())
-			{
-				AddToCriterion(adtCriterion, padtTable->GetTable()["BEGN_END_IN"], padtGLAccount->GetFactsIIBeginEndIndicator().GetValue(), bInclude);
-			}
-
-			// Add facts attribute criteria
-			AddFactsAttributeCriteria(adtCriterion, padtParameterGroup, (padtParameterGroup->IsFacts1Report() ? 
-				padtGLAccount->GetFacts1Attributes() : padtGLAccount->GetFacts2Attributes()), padtTable, bInclude);
-
-			// Add to the include/exclude criteria list
-			if(bInclude)
-				adtIncludeDeque.push_back(adtCriterion);
-			else
-				adtExcludeDeque.push_back(adtCriterion);
-		}
-
-		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddFactsAttributeCriteria(AmsDBCriterion & adtCriterion,
-														 FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsManyRelationPtr padtAttributes, 
-														 AmsTableMapPtr padtTable, const AmsBoolean& bInclude)
-{
-	if(padtAttributes->Size())
-	{
-		AmsDBCriterion adtAttributeCriterion;
-
-		for(AmsInt i = 0; i < padtAttributes->Size(); i++)
-		{
-			FfsExternalReportAbstractCellGLAccountFACTS1AttributeValue padtGLFacts1;
-			FfsExternalReportAbstractCellGLAccountFACTS2AttributeValue padtGLFacts2;
-
-			if(padtParameterGroup->IsFacts1Report)
-				padtGLFacts1 = (*padtAttributes)[i];
-			else
-				padtGLFacts2 = (*padtAttributes)[i];
-
-			AmsString strAttributeNumber = (padtGLFacts1 ? padtGLFacts1->GetAttributeNumber().GetValue() : 
-				padtGLFacts2->GetAttributeNumber().GetValue());
-
-			// Remove leading zero if necessary
-			strAttributeNumber = (strAttributeNumber(0,1) == "0" ? strAttributeNumber(1) : strAttributeNumber);
-
-			AmsString strDomainValue = (padtGLFacts1 ? padtGLFacts1->GetDomainValue().GetValue() : 
-				padtGLFacts2->GetDomainValue().GetValue());
-
-			AddToSubCriterion(adtCriterion, padtTable->GetTable()["ATTR_" + strAttributeNumber + "_VAL"], strDomainValue, bInclude);
-		}
-
-		if(bInclude)
-			adtCriterion = adtCriterion && (adtAttributeCriterion);
-		else
-			adtCriterion = adtCriterion || (adtAttributeCriterion);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddTradingPartnerCriteria(AmsDBSelector& adtSelector, 
-														 FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
-														 AmsManyRelationPtr padtTradingPartners, AmsTableMapPtr padtTable)
-{
-	if(padtTradingPartners->Size())
-	{
-		AmsString strTradingPartnerAttributeNumber = NULL;
-
-		if(padtParameterGroup->IsFactsAbstractExternalReport())
-		{
-			strTradingPartnerAttributeNumber = GetFactsAttributeNumber(
-				(padtParameterGroup->IsFacts1Report() ? "TRDG_PTNR_AGCY_FL" : "TRFR_AGCY_ACCT_FL"), padtParameterGroup);
-		}
-
-		deque<AmsString> adtIncludeDeque;
-		deque<AmsString> adtExcludeDeque;
-
-		for(AmsInt i = 0; i < padtTradingPartners->Size(); i++
-		{
-			FfsExternalReportAbstractDefinitionCellTradingPartnerPtr padtPartner = (*padtTradingPartners)[i];
-
-			if(padtPartner->GetIncludeExcludeIndicator().GetValue() == FfsExternalReportAbstractDefinitionCell::INCLUDE)
-				adtIncludeDeque.push_back(padtPartner->GetTradingPartner().GetValue());
-			else
-				adtExcludeDeque.push_back(padtPartner->GetTradingPartner().GetValue());
-		}
-
-		if(padtParameterGroup->IsFactsAbstractExternalReport())
-		{
-			AddCriterionToSelector(adtSelector, padtTable->GetTable()["ATTR_" + strTradingPartnerAttributeNumber + "_VAL"],
-				adtIncludeDeque, adtExcludeDeque);
-		}
-		else
-		{
-			AddCriterionToSelector(adtSelector, padtTable->GetTable()["TRDG_PTNR"], adtIncludeDeque, adtExcludeDeque);
-		}
-
-        if(padtParameterGroup->IsGLRollup)
-           AddGLTransferTSYMCriteria(adtSelector, padtPartner, padtTable);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddFactsFederalNonFederalCriteria(AmsDBSelector& adtSelector, 
-																 FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, const AmsString& strFederalNonFederalIndicator, AmsTableMapPtr padtTable)
-{
-	if(!strFederalNonFederalIndicator.isNull())
-	{
-		AmsString strFederalNonFederalAttributeNumber = GetFactsAttributeNumber(
-			(padtParameterGroup->IsFacts1Report() ? "TRDG_PTNR_FL" : "TRAN_PTNR_FL"), padtParameterGroup);
-
-		if(strFederalNonFederalIndicator == NON_FEDERAL && padtParameterGroup->IsFacts2Report())
-		{ // Translate non federal to X/E
-			adtSelector.where(adtSelector.where() && 
-				(padtTable->GetTable()["ATTR_" + strFederalNonFederalAttributeNumber + "_VAL"] == "X" ||
-				padtTable->GetTable()["ATTR_" + strFederalNonFederalAttributeNumber + "_VAL"] == "E"));
-		}
-		else // otherwise just use the value directly
-		{
-			adtSelector.where(adtSelector.where() && padtTable->GetTable()["ATTR_" + strFederalNonFederalAttributeNumber + "_VAL"] ==
-				strFederalNonFederalIndicator);
-		}
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddTreasurySymbolCriteria(AmsDBSelector& adtSelector,
-														 FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsManyRelationPtr padtTreasurySymbols, AmsTableMapPtr padtTable)
-{
-	if(padtTreasurySymbols->Size())
-	{
-		AmsString strColumn;
-
-		if(padtParameterGroup->IsGLRollup() || padtParameterGroup->IsFacts2Report())
-			strColumn = "TSYM";
-		else
-			strColumn = "FT_FUND_GRP";
-
-		deque<AmsString> adtIncludeDeque;
-		deque<AmsString> adtExcludeDeque;
-
-		for(AmsInt i = 0; i < padtTreasurySymbols->Size(); i++)
-		{
-			AmsString strValue;
-			FfsExternalReportAbstractDefinitionTreasurySymbolPtr padtTSYM = (*padtTreasurySymbols)[i];
-			AmsBoolean bInclude = padtTSYM->GetIncludeExcludeIndicator().GetValue();
-
-			if(padtParameterGroup->IsFacts1Report())
-				strValue = padtTSYM->GetFactsFundGroup().GetValue();
-
-			if(padtParameterGroup->IsGLRollup() || padtParameterGroup->IsFacts2Report())
-			{
-				if(bInclude)
-					AddTreasurySymbolCriterion(padtTSYM, padtParameterGroup, adtIncludeDeque, bInclude, padtTable);
-				else
-					AddTreasurySymbolCriterion(padtTSYM, padtParameterGroup, adtExcludeDeque, bInclude, padtTable);
-			}
-			else // FACTS I report
-			{
-				if(bInclude)
-					adtIncludeDeque.push_back(strValue);
-				else
-					adtExcludeDeque.push_back(strValue);
-			}
-		}
-
-		AddCriterionToSelector(adtSelector, padtTable->GetTable()[strColumn], adtIncludeDeque, adtExcludeDeque);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddFactsFundCriteria(AmsDBSelector& adtSelector, FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
-														 AmsManyRelationPtr padtDimensionStrips, AmsTableMapPtr padtTable)
-{
-	if(padtDimensionStrips->Size())
-	{
-		deque<AmsDBCriterion> adtIncludeDeque;
-		deque<AmsDBCriterion> adtExcludeDeque;
-
-		for(AmsInt i = 0; i < padtDimensionStrips->Size(); i++)
-		{
-			FfsExternalReportAbstractDefinitionDimensionStripPtr padtDimStrip = (*padtDimensionStrips)[i];
-			AmsBoolean bInclude = padtDimensionStrip->GetIncludeExcludeIndicator().GetValue();
-
-			// Add fund criterion
-			if(bInclude)
-				AddFactsFundCriterion(padtDimStrip, adtIncludeDeque, bInclude, padtTable);
-			else
-				AddFactsFundCriterion(padtDimStrip, adtExcludeDeque, bInclude, padtTable);
-		}
-
-		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddAbstractExternalReportCriteria(AmsDBSelector& adtSelector,
-														 AmsManyRelationPtr padtAbstractExternalReportDefinitions, AmsTableMapPtr padtTable)
-{
-	if(padtAbstractExternalReportDefinitions->Size())
-	{
-		AmsDBCriterion adtCriterion;
-		deque<AmsCriterion> adtIncludeDeque;
-		deque<AmsCriterion> adtExcludeDeque;
-
-		for(AmsInt i = 0; i < padtAbstractExternalReportDefinitions->Size(); i++)
-		{
-			FfsERSystemAssuranceDefinitionCellAbstractExternalReportDefinitionPtr padtDefinition = (FfsERSystemAssuranceDefinitionCellAbstractExternalReportDefinitionPtr)(*padtAbstractExternalReportDefinitions)[i];
-
-			adtCriterion = padtTable->GetTable()["SEC_NUM"] == padtDefinition->GetSectionNumber().GetValue() &&
-				padtTable->GetTable()["LNUM"] == padtDefinition->GetLineNumber().GetValue() && padtTable->GetTable()["COLM_NUM"] ==
-				padtDefinition->GetColumnNumber().GetValue() && padtTable->GetTable()["TYP"] == "";
-
-			adtIncludeDeque.push_back(adtCriterion);
-		}
-
-		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddTreasurySymbolCriterion(FfsExternalReportAbstractDefinitionTreasurySymbolPtr padtTreasurySymbol,
-														  FfsERSystemAssuranceParameterGroup padtParameterGroup,
-														  deque<AmsString> &adtDeque, const AmsBoolean& bInclude, 
-														  AmsTableMapPtr padtTable)
-{
-	AmsDBSelector adtSelector;
-	FfsTreasurySymbolSQLPtr padtTreasurySymbolSQL = (FfsTreasurySymbolSQLPtr).GetPOFactory(FfsTreasurySymbol).GetStorage();
-	AmsDBTable adtTreasurySymbolTable = padtTreasurySymbolSQL->GetTables()->front()->GetTable();
-
-	if(padtParameterGroup->IsFacts2Report())
-		adtSelector << adtTreasurySymbolTable["UIDY"];
-	else
-		adtSelector << adtTreasurySymbolTable["TSYM"];
-
-	if(padtTreasurySymbol->GetAgency().GetValue())
-	{
-		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["S133_AGCY_ID"] == 
-			padtTreasurySymbol->GetAgency().GetValue());
-	}
-
-	if(padtTreasurySymbol->GetSourceAgency().GetValue())
-	{
-		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["SRCE_AGCY_ID"] == 
-			padtTreasurySymbol->GetSourceAgency().GetValue());
-	}
-
-	if(padtTreasurySymbol->GetAvailableFromYear().GetValue())
-	{
-		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["AVAL_FROM_YEAR"] ==
-			padtTreasurySymbol->GetAvailableFromYear().GetValue());
-	}
-
-	if(padtTreasurySymbol->GetAvailableToYear().GetValue())
-	{
-		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["AVAL_TO_YEAR"] ==
-			padtTreasurySymbol->GetAvailableToYear().GetValue());
-	}
-
-	if(padtTreasurySymbol->GetAvailabilityType().GetValue())
-	{
-		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["AVAL_TYP"] ==
-			padtTreasurySymbol->GetAvailabilityType().GetValue());
-	}
-
-	if(padtTreasurySymbol->GetFundSymbol().GetValue())
-	{
-		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["FUND_SYMB"] ==
-			padtTreasurySymbol->GetFundSymbol().GetValue());
-	}
-
-	if(padtTreasurySymbol->GetSubAccount().GetValue())
-	{
-		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["SUB_ACCT"] ==
-			padtTreasurySymbol->GetSubAccount().GetValue());.
-	}
-
-	AmsGenericReaderPtr padtReader  = new AmsGenericReader(adtSelector, (AmsDBReadOnlyConnectionPtr) NULL);
-	AmsString strTSYMIdentifier;
-
-	if(padtReader)
-	{
-		while(padtReader->NextRow())
-		{
-			(*padtReader) >> strTSYMIdentifier;
-			AmsDBCriterion adtCriterion;
-
-			if(padtParameterGroup->IsFacts2Report())
-				AddToCriterion(adtCriterion, padtTable->GetTable()["TSYM_ID"], strTSYMIdentifier, bInclude);
-			else
-				AddToCriterion(adtCriterion, padtTable->GetTable()["TSYM"], strTSYMIdentifier, bInclude);
-
-			adtDeque.push_back(adtCriterion);
-		}
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddFactsFundCriterion(FfsExternalReportAbstractDefinitionDimensionStripPtr padtDimensionStrip,
-													 deque<AmsString> &adtDeque, const AmsBoolean& bInclude, AmsTableMapPtr padtTable)
-{
-	AmsDBSelector adtSelector;
-	FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr).GetPOFactory(FfsFund).GetStorage();
-	AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
-	
-	adtSelector << adtFundTable["UIDY"];
-	
-	if(padtDimensionStrip->GetFund().GetValue())
-		adtSelector.where(adtSelector.where() && adtFundTable["CD"] == padtDimensionStrip->GetFund().GetValue());
-
-	if(padtDimensionStrip->GetBegBudgetFY().GetValue())
-		adtSelector.where(adtSelector.where() && adtFundTable["BBFY"] == padtDimensionStrip->GetBegBudgetFY().GetValue());
-
-	if(padtDimensionStrip->GetEndBudgetFY().GetValue().isNull())
-    {
-        if(bInclude)
-		    adtSelector.where(adtSelector.where() && adtFundTable["EBFY"].isNull());
-	else
-            adtSelector.where(adtSelector.where() || !adtFundTable["EBFY"].isNull());
-    }
-	else
-		adtSelector.where(adtSelector.where() && adtFundTable["EBFY"] == padtDimensionStrip->GetEndBudgetFY().GetValue());
-
-	if(padtDimensionStrip->GetPartitionId().GetValue())
-		adtSelector.where(adtSelector.where() && adtFundTable["PATN_ID"] == padtDimensionStrip->GetPartitionId().GetValue());
-
-	AmsGenericReaderPtr padtReader  = new AmsGenericReader(adtSelector, (AmsDBReadOnlyConnectionPtr) NULL);
-	AmsString strIdentity;
-	
-	if(padtReader)
-	{
-		while(padtReader->NextRow())
-		{
-			(*padtReader) >> strIdentity;
-			AmsDBCriterion adtCriterion;
-			
-			AddToCriterion(adtCriterion, padtTable->GetTable()["FUND_ID"], strIdentity, bInclude);
-
-			adtDeque.push_back(adtCriterion);
-		}
-	}
-}
-
-AmsString
-FfsERSystemAssuranceProcessor::GetFactsAttributeNumber(const AmsString& strColumn, FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
-{
-	if(padtParameterGroup->IsFacts1Report())
-	{
-		return GetFactsAttributeNumber(&(GetPOFactory(FfsFACTSAttributeDefinition)), madtFacts1AttributeNumberCacheMap, 
-			strColumn, padtParameterGroup->GetFiscalYear());
-	}
-	else
-	{
-		return GetFactsAttributeNumber(&(GetPOFactory(FfsFACTS2AttributeDefinition)), madtFacts2AttributeNumberCacheMap, 
-			strColumn, padtParameterGroup->GetFiscalYear()));
-	}
-}
-
-AmsString
-FfsERSystemAssuranceProcessor::GetFactsAttributeNumber(AmsBaseFactoryPtr padtFactory, 
-													   map< AmsString, map<AmsString, AmsString>* >& adtCacheMap, const AmsString& strColumn, const AmsString& strFiscalYear)
-{
-	// Look in the cache first
-	map< AmsString, map<AmsString, AmsString>* >::iterator it =  adtCacheMap.find(strFiscalYear);
-
-	if(it != adtCacheMap.end())
-	{
-		map<AmsString, AmsString>::iterator itColumn = (*it).second->find(strColumn);
-
-		if(itColumn != (*it).second->end())
-		{
-			return (*itColumn).second;
-		}
-	}
-
-	// Didn't find it in the cache, so we need to look in the db
-	AmsDBSelector adtSelector;
-	AmsPersistentStoragePtr padtSQL = padtFactory->GetStorage();
-	AmsTableMapPtr padtTable = padtSQL->GetTables()->front();
-
-	adtSelector << padtTable->GetTable()["ATTR_NUM"];
-	adtSelector.where(adtSelector.where() && padtTable->GetTable()["FISC_YEAR"] = strFiscalYear);
-	adtSelector.where(adtSelector.where() && padtTable->GetTable()[strColumn] = "T");
-
-	AmsString strAttributeNumber;
-	AmsGenericReaderPtr padtReader  = new AmsGenericReader(adtSelector, (AmsDBReadOnlyConnectionPtr) NULL);
-
-	if (padtReader->NextRow())
-	{
-		*padtReader >> strAttributeNumber;
-	}
-
-	// Remove leading zero if necessary
-	strAttributeNumber = (strAttributeNumber(0,1) == "0" ? strAttributeNumber(1) : strAttributeNumber);
-
-	// Put the result in cache
-	if(it == adtCacheMap.end())// need to create the map for the fiscal year
-	{
-		adtCacheMap[strFiscalYear] = new map<String, String>;
-		it = adtCacheMap.find(strFiscalYear)
-	}
-
-	(*(*it).second)[strColumn] = strAttributeNumber;
-	return strAttributeNumber;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddCriterionToSelector(AmsDBSelector& adtSelector, const AmsDBColumn &adtColumn,
-													  deque<AmsString> &adtIncludeDeque, deque<AmsString> &adtExcludeDeque)
-{
-	if(adtIncludeDeque.size())
-	{
-		AmsDBCriterion adtIncludeCriterion = AmsSQLHelper::BuildInClauseForStringDeque(adtColumn, adtIncludeDeque, FALSE, FALSE);
-		adtSelector.where( adtSelector.where() && ( adtIncludeCriterion ) );
-	}
-
-	if(adtExcludeDeque.size())
-	{
-		AmsDBCriterion adtExcludeCriterion = AmsSQLHelper::BuildInClauseForStringDeque(adtColumn, adtExcludeDeque, FALSE, TRUE);
-		adtSelector.where( adtSelector.where() && ( adtExcludeCriterion ) );
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddCriterionToSelector(AmsDBSelector& adtSelector, deque<AmsDBCriterion> &adtIncludeDeque, deque<AmsDBCriterion> &adtExcludeDeque)
-{
-	if(adtIncludeDeque.size())
-	{
-		AmsDBCriterion adtIncludeCriterion;
-
-		for(AmsInt i = 0; i < adtIncludeDeque.size(); i++)
-		{
-			AmsDBCriterion adtTempCriterion = adtIncludeDeque[i];
-			adtIncludeCriterion = adtIncludeCriterion || ( adtTempCriterion );
-		}
-
-		adtSelector.where( adtSelector.where() && ( adtIncludeCriterion ) );
-	}
-
-	if(adtExcludeDeque.size())
-	{
-		AmsDBCriterion adtExcludeCriterion;
-
-		for(AmsInt i = 0; i < adtExcludeDeque.size(); i++)
-		{
-			AmsDBCriterion adtTempCriterion = adtExcludeDeque[i];
-			adtExcludeCriterion = adtExcludeCriterion && ( adtTempCriterion );
-		}
-
-		adtSelector.where( adtSelector.where() && ( adtExcludeCriterion ) );
-	}
-}
-
-AmsString
-FfsERSystemAssuranceProcessor::ConvertToGLAccountId(const AmsString& strGLAccount, FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
-{
-	FfsGLAccountReference adtGLAccountRef;  
-	AmsStringAspect adtFiscalYear;
-	adtGLAccountRef.ConnectTo( adtFiscalYear );
-	adtGLAccountRef.SetCodeAspect( strGLAccount );
-	adtFiscalYear.SetValue( padtParameterGroup->GetFiscalYear() );
-	adtGLAccountRef.AsIdentity()
-
-		return adtGLAccountRef.GetIdentityAspect().GetValue();
-}
-
-AmsDBSelector
-FfsERSystemAssuranceProcessor::GetGLSelector(const AmsString& strSelectedColumn, const AmsString& strSelectedByColumn1, const AmsString& strValue1,
-											 const AmsString& strSelectedByColumn2, const AmsString& strValue2)
-{
-	AmsDBSelector adtReturnSelector; 
-	FfsGLAccountSQLPtr padtGLSQL = (FfsGLAccountSQLPtr).GetPOFactory(FfsGLAccount).GetStorage();
-	AmsDBTable adtGLTable = padtGLSQL->GetTables()->front()->GetTable();
-	adtReturnSelector << adtGLTable[strSelectedColumn];
-	adtReturnSelector.where(adtReturnSelector.where() && adtGLTable[strSelectedByColumn1] = strValue1);
-
-	if(!strSelectedByColumn2.isNull())
-	{
-		adtReturnSelector.where(adtReturnSelector.where() && adtGLTable[strSelectedByColumn2] = strValue2);
-	}
-
-	return adtReturnSelector;
-}
-
-AmsDBSelector
-FfsERSystemAssuranceProcessor::GetClosingPeriodSelector(const AmsString& strFiscalYear)
-{
-	AmsDBSelector adtReturnSelector;
-	FfsAccountingPeriodSQLPtr padtAccountingPeriodSQL = (FfsAccountingPeriodSQLPtr).GetPOFactory(FfsAccountingPeriod).GetStorage();
-	AmsDBTable adtAccountingPeriodTable = padtAccountingPeriodSQL->GetTables()->front()->GetTable();
-	adtReturnSelector << adtAccountingPeriodTable["FISC_MNTH"];
-	adtReturnSelector.where(adtReturnSelector.where() && adtAccountingPeriodTable["CLSG_PERD_FL"] == "T" 
-		&& adtAccountingPeriodTable["FISC_YEAR"] == strFiscalYear);
-	return adtReturnSelector;
-}
-
-AmsDBSelector
-FfsERSystemAssuranceProcessor::GetBeginningPeriodSelector(const AmsString& strFiscalYear)
-{
-	AmsDBSelector adtReturnSelector;
-	FfsAccountingPeriodSQLPtr padtAccountingPeriodSQL = (FfsAccountingPeriodSQLPtr).GetPOFactory(FfsAccountingPeriod).GetStorage();
-	AmsDBTable adtAccountingPeriodTable = padtAccountingPeriodSQL->GetTables()->front()->GetTable();
-	adtReturnSelector << adtAccountingPeriodTable["FISC_MNTH"];
-	adtReturnSelector.where(adtReturnSelector.where() && adtAccountingPeriodTable["BEGN_PERD_FL"] == "T"
-		&& adtAccountingPeriodTable["FISC_YEAR"] == strFiscalYear);
-	return adtReturnSelector;
-}
-
-AmsDBSelector
-FfsERSystemAssuranceProcessor::GetFiscalMonthsByQuarterSelector(const AmsString& strFiscalYear, const AmsString& strFiscalQuarter)
-{
-	AmsDBSelector adtReturnSelector;
-	FfsAccountingPeriodSQLPtr padtAccountingPeriodSQL = (FfsAccountingPeriodSQLPtr).GetPOFactory(FfsAccountingPeriod).GetStorage();
-	AmsDBTable adtAccountingPeriodTable = padtAccountingPeriodSQL->GetTables()->front()->GetTable();
-	adtReturnSelector << adtAccountingPeriodTable["FISC_MNTH"];
-	adtReturnSelector.where(adtReturnSelector.where() && adtAccountingPeriodTable["FISC_YEAR"] == strFiscalYear
-		&& adtAccountingPeriodTable["FISC_QUAR"] == strFiscalQuarter);
-	return adtReturnSelector;
-}
-
-FfsERSystemAssuranceReportCellDetailPtr
-FfsERSystemAssuranceProcessor::FindNextCell(map<AmsInt, FfsERSystemAssuranceReportCellDetailPtr, less<AmsInt>> adtCellsMap)
-{
-	FfsERSystemAssuranceReportCellDetailPtr padtReturn = NULL;
-	AmsInt iReader = -1;
-
-	map<AmsInt, FfsERSystemAssuranceReportCellDetailPtr, less<AmsInt>>::iterator it = adtCellsMap.begin();
-
-	for( ; it != padtReaderMap.end(); it++)
-	{
-		FfsERSystemAssuranceReportCellDetailPtr padtCellDetail = (*it).second;
-
-		if(padtReturn == NULL || (*padtCellDetail) < (*padtReturn))
-		{
-			padtReturn = padtCellDetail;
-			iReader = (*it).first;
-		}
-	}
-
-	it = adtCellsMap.find(iReader);
-	adtCellsMap.erase(it);
-	return padtReturn;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::ReadNextCell(map<AmsInt, FfsERSystemAssuranceReportCellDetailPtr, less<AmsInt>> adtCells, map<AmsInt, AmsReaderPtr, less<AmsInt>>* padtReaderMap, AmsString strLineNumber)
-{
-	map<AmsInt, AmsReaderPtr, less<AmsInt>>::iterator it = padtReaderMap.begin();
-
-	for( ; it != padtReaderMap.end(); it++)
-	{
-		AmsInt iReader = (*it).first;
-		map<AmsInt, AmsReaderPtr, less<AmsInt>>::iterator itCell = adtCells.find(iReader);
-
-		if(itCell == adtCells.end() || (*itCell).second == NULL)
-		{
-			AmsReaderPtr padtReader = (*it).second;
-
-			if(padtReader && padtReader->NextRow())
-			{
-				map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>::iterator itParam = madtColumnParameters.find(iReader);
-				FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = (*itParam).second;
-				adtCells[iReader] = CreateReportCellDetail(padtParameterGroup, padtReader, strLineNumber);
-			}
-		}
-	}
-}
-
-FfsERSystemAssuranceReportCellDetailPtr
-FfsERSystemAssuranceProcessor::CreateReportCellDetail(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsReaderPtr padtReader, AmsString strLineNumber)
-{
-	if(padtParameterGroup->IsAbstractExternalReport())
-		return CreateAbstractExternalReportCellDetail(padtParameterGroup, padtReader, strLineNumber);
-	else if(padtParameterGroup->IsFactsAbstractExternalReport())
-		return CreateFactsAbstractReportCellDetail(padtParameterGroup, padtReader, strLineNumber);
-	else if(padtParameterGroup->IsGLRollup())
-		return CreateGLRollupCellDetail(padtParameterGroup, padtReader, strLineNumber);
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddFundBureauCriterion(const AmsString& strBureauId, deque<AmsString> &adtDeque, const AmsBoolean& bInclude, AmsTableMapPtr padtTable)
-{
-	FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr).GetPOFactory(FfsFund).GetStorage();
-	AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
-	AmsDBCriterion adtCriterion;
-	adtCriterion = (adtFundTable["BURU_ID"] = strBureauId);
-	AddFundCriterion(adtCriterion, adtDeque, bInclude, padtTable);
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddFundFactsInclusionCriterion(const AmsString& strFacts1, const AmsString& strFacts2, 
-															  deque<AmsString> &adtDeque, const AmsBoolean& bInclude, AmsTableMapPtr padtTable)
-{
-	FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr).GetPOFactory(FfsFund).GetStorage();
-	AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
-	AmsDBCriterion adtCriterion;
-	adtCriterion = (adtFundTable["FCTS_INCL_FL"] == strFacts1 && adtFundTable["FCT2_INCL_FL"] == strFacts2);
-	AddFundCriterion(adtCriterion, adtDeque, bInclude, padtTable);
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddFundCriterion(AmsDBCriterion& adtCriterion, deque<AmsString> &adtDeque, const AmsBoolean& bInclude, AmsTableMapPtr padtTable)
-{
-	AmsDBSelector adtSelector;
-	FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr).GetPOFactory(FfsFund).GetStorage();
-	AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
-	adtSelector << adtFundTable["CD"];
-	adtSelector << adtFundTable["BBFY"];
-	adtSelector << adtFundTable["EBFY"];
-	adtSelector << adtFundTable["PATN_ID"];
-	adtSelector.where(adtSelector.where() && adtCriterion);
-	AmsGenericReaderPtr padtReader  = new AmsGenericReader(adtSelector, (AmsDBReadOnlyConnectionPtr) NULL);
-
-	AmsDBColumn adtBBFYColumn = padtTable->GetTable()["BBFY"];
-	AmsDBColumn adtEBFYColumn = padtTable->GetTable()["EBFY"];
-	AmsDBColumn adtFundColumn = padtTable->GetTable()["FUND"];
-	AmsDBColumn adtPartitionColumn = padtTable->GetTable()["PATN"];
-
-	AmsString strFund, strBBFY, strEBFY, strPartitionId;
-
-	if(padtReader)
-	{
-		while(padtReader->NextRow())
-		{
-			(*padtReader) >> strFund;
-			(*padtReader) >> strBBFY;
-			(*padtReader) >> strEBFY;
-			(*padtReader) >> strPartitionId;
-
-			AmsDBCriterion adtTempCriterion;
-
-			AddToCriterion(adtTempCriterion, adtFundColumn, strFund, bInclude);
-			AddToCriterion(adtTempCriterion, adtBBFYColumn, strBBFY, bInclude);
-
-			if(strEBFY.isNull())
-			{
-				if(bInclude)
-					adtTempCriterion = adtTempCriterion && adtEBFYColumn.isNull();
-				else
-					adtTempCriterion = adtTempCriterion || !adtEBFYColumn.isNull();
-			}
-			else
-				AddToCriterion(adtTempCriterion, adtEBFYColumn, strEBFY, bInclude);
-
-			if(!strPartitionId.isNull())
-				AddToCriterion(adtTempCriterion, adtPartitionColumn, ConvertToPartitionCode(strPartitionId), bInclude);
-
-			adtDeque.push_back(adtTempCriterion);
-		}
-	}
-}
-
-FfsERSystemAssuranceReportCellDetailPtr
-FfsERSystemAssuranceProcessor::CreateAbstractExternalReportCellDetail(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, 
-																	  AmsReaderPtr padtReader, AmsString strLineNumber)
-{
-	FfsExternalReportAbstractReportCellPtr padtCell = (FfsExternalReportAbstractReportCellPtr)(padtParameterGroup->GetDetailFactory().CreateSingleInstanceAb(padtReader));
-	FfsERSystemAssuranceReportCellDetailPtr padtCellDetail = NULL;
-
-	if(padtCell)
-	{
-		FfsERSystemAssuranceDefinitionColumnPtr padtColumn = padtParameterGroup->GetColumnObj();
-
-		FfsExternalReportAbstractReportReference adtReport;
-		adtReport.SetIdentityAspect(padtCell->GetParentIdentity().GetValue());
-		adtReport.AsIdentity();
-		FfsExternalReportAbstractReportPtr padtReport = adtReport.GetReportObj();
-
-		padtCellDetail->SetLineNumber(strLineNumber);
-		padtCellDetail->SetColumnNumber(padtParameterGroup->GetColumnNumber());
-
-		if(padtReport)
-			padtCellDetail->SetPartition(padtReport->GetPartition().GetValue());
-
-		padtCellDetail->SetLinkId(padtCell->GetIdentityValue());
-
-		if(padtColumn->GetOriginalReportedAmountIndicator().GetValue() == FfsERSystemAssuranceDefinitionColumn::ORIGINAL)
-			padtCellDetail->SetAmount(padtCell->GetOriginalAmount().GetValue());
-		else if(padtColumn->GetOriginalReportedAmountIndicator().GetValue() = FfsERSystemAssuranceDefinitionColumn::REPORTED)
-			padtCellDetail->SetAmount(padtCell->GetTotalAmount().GetValue());
-
-		if(padtParameterGroup->IsSF133Report())
-		{
-			FfsFundReference adtFund;
-			adtFund.SetCodeAspect(padtCell->GetFund().GetValue());
-			adtFund.SetBeginningBudgetFYAspect(padtCell->GetBeginningBudgetFiscalYear().GetValue());
-			adtFund.SetEndingBudgetFYAspect(padtCell->GetEndingBudgetFiscalYear().GetValue());
-			adtFund.AsIdentity();
-
-			padtCellDetail->SetFundId(adtFund.GetIdentityValue());
-			padtCellDetail->SetTreasurySymbolId(adtFund.GetFundObj().GetTreasurySymbolId().GetValue());
-		}
-
-		delete padtCell;
-	}
-
-	return padtCellDetail;
-}
-
-FfsERSystemAssuranceReportCellDetailPtr
-FfsERSystemAssuranceProcessor::CreateFactsAbstractReportCellDetail(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, 
-																   AmsReaderPtr padtReader, AmsString strLineNumber)
-{
-	FfsFactsAbstractReportDetailPtr padtDetail = NULL;
-	FfsERSystemAssuranceReportCellDetailPtr padtCellDetail = NULL;
-
-	padtDetail = (FfsFactsAbstractReportDetailPtr)(GetFactory().CreateSingleInstanceAb(padtReader));
-
-	if(padtDetail)
-	{
-		FfsERSystemAssuranceDefinitionColumnPtr padtColumn = padtParameterGroup->GetColumnObj();
-
-		padtCellDetail->SetLineNumber(strLineNumber);
-		padtCellDetail->SetColumnNumber(padtParameterGroup->GetColumnNumber());
-		padtCellDetail->SetPartition(padtDetail->GetPartition().GetValue());
-
-		if(padtParameterGroup->IsFacts1Report())
-			padtCellDetail->SetFactsFundGroup(padtDetail->GetFactsFundGroup().GetValue());
-
-		if(padtParameterGroup->IsFacts1PreliminaryReport())
-			padtCellDetail->SetFundId(padtDetail->GetFundId().GetValue());
-
-		if(padtParameterGroup->IsFacts2Report())
-			padtCellDetail->SetTreasurySymbolId(padtDetail->GetTreasurySymbolId().GetValue());
-
-        if(strTradingPartnerAttributeNumber == "1")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute1Value());
-        else if(strTradingPartnerAttributeNumber == "2")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute2Value());
-        else if(strTradingPartnerAttributeNumber == "3")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute3Value());
-        else if(strTradingPartnerAttributeNumber == "4")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute4Value());
-        else if(strTradingPartnerAttributeNumber == "5")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute5Value());
-        else if(strTradingPartnerAttributeNumber == "6")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute6Value());
-        else if(strTradingPartnerAttributeNumber == "7")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute7Value());
-        else if(strTradingPartnerAttributeNumber == "8")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute8Value());
-        else if(strTradingPartnerAttributeNumber == "9")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute9Value());
-        else if(strTradingPartnerAttributeNumber == "10")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute10Value());
-        else if(strTradingPartnerAttributeNumber == "11")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute11Value());
-        else if(strTradingPartnerAttributeNumber == "12")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute12Value());
-        else if(strTradingPartnerAttributeNumber == "13")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute13Value());
-        else if(strTradingPartnerAttributeNumber == "14")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute14Value());
-        else if(strTradingPartnerAttributeNumber == "15")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute15Value());
-        else if(strTradingPartnerAttributeNumber == "16")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute16Value());
-        else if(strTradingPartnerAttributeNumber == "17")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute17Value());
-        else if(strTradingPartnerAttributeNumber == "18")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute18Value());
-        else if(strTradingPartnerAttributeNumber == "19")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute19Value());
-        else if(strTradingPartnerAttributeNumber == "20")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute20Value());
-        else if(strTradingPartnerAttributeNumber == "21")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute21Value());
-        else if(strTradingPartnerAttributeNumber == "22")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute22Value());
-        else if(strTradingPartnerAttributeNumber == "23")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute23Value());
-        else if(strTradingPartnerAttributeNumber == "24")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute24Value());
-        else if(strTradingPartnerAttributeNumber == "25")
-           padtCellDetail->SetTradingPartner(padtDetail->GetAttribute25Value());
-
-		padtCellDetail->SetLinkId(padtDetail->GetIdentityValue());
-
-		if(padtColumn->GetOriginalReportedAmountIndicator().GetValue() == FfsERSystemAssuranceDefinitionColumn::ORIGINAL)
-			padtCellDetail->SetAmount(padtCell->GetOriginalAmount().GetValue());
-		else if(padtColumn->GetOriginalReportedAmountIndicator().GetValue() = FfsERSystemAssuranceDefinitionColumn::REPORTED)
-			padtCellDetail->SetAmount(padtCell->GetReportedAmount().GetValue());
-
-		delete padtDetail;
-	}
-
-	return padtCellDetail;
-}
-
-FfsERSystemAssuranceReportCellDetailPtr
-FfsERSystemAssuranceProcessor::CreateGLRollupCellDetail(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, 
-														AmsReaderPtr padtReader, AmsString strLineNumber)
-{
-	FfsGLAcctBalancePtr padtBalance = (FfsGLAcctBalancePtr)(GetFactory().CreateSingleInstanceAb(padtReader));
-	FfsERSystemAssuranceReportCellDetailPtr padtCellDetail = NULL;
-
-	if(padtBalance)
-	{
-		padtCellDetail->SetLineNumber(strLineNumber);
-		padtCellDetail->SetColumnNumber(padtParameterGroup->GetColumnNumber());
-		padtCellDetail->SetPartition(padtBalance->GetPartition().GetValue());
-		padtCellDetail->SetFundId(padtBalance->GetFundAsIdentity());
-		padtCellDetail->SetTreasurySymbolId(padtBalance->GetTreasurySymbolId().GetValue());
-
-		FfsAgencyReference adtTradingPartner;
-		adtTradingPartner.SetCodeAspect(padtBalance->GetTradingPartner().GetValue());
-		adtTradingPartner.AsIdentity();
-
-		padtCellDetail->SetTradingPartnerId(adtTradingPartner.GetIdentityAspect());
-      
-        if(padtCellDetail->GetFundObj())
-           padtCellDetail->SetFactsFundGroup(padtCellDetail->GetFundObj()->GetFactsFundGroup());
-
-		padtCellDetail->SetLinkId(padtBalance->GetIdentityValue());
-		padtCellDetail->SetAmount(padtBalance->GetDebitBalance().GetValue() - padtBalance->GetCreditBalance().GetValue());
-
-		delete padtBalance;
-	}
-
-	return padtCellDetail;
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::CreateTotalsLine(FfsERSystemAssuranceReportPtr padtReport, FfsERSystemAssuranceDefinitionLinePtr padtLine)
-{
-   	// This method creates the totals lines.  calculateAmounts will actually do the calculations.
-	
-	for(AmsInt i = 0; i < padtLine->LineTotalCount(); i++)
-			{
-		FfsERSystemAssuranceDefinitionLineTotalPtr padtTotal = padtLine->GetLineTotal(i);
-				AmsString strFromLine = padtTotal->GetLineNumber().GetValue();
-				AmsInt iAddOrSubtract = padtTotal->DetermineAddOrSubtract();
-
-				FfsERSystemAssuranceReportLinePtr padtReportLine = CreateNewReportLine(padtReport, padtLine);
-			}
-		}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::CreateTotalsColumn(FfsERSystemAssuranceDefinitionColumnPtr padtColumn,
-                                                  FfsERSystemAssuranceReportLinePtr padtReportLine, FfsERSystemAssuranceReportCellDetailPtr padtCell)
-		{
-	for(AmsInt i = 0; i < padtColumn->ColumnTotalCount(); i++)
-			{
-		FfsERSystemAssuranceDefinitionColumnTotalPtr padtTotal = padtColumn->GetColumnTotal(i);
-				AmsString strFromColumn = padtTotal->GetColumnNumber().GetValue();
-				AmsInt iAddOrSubtract = padtTotal->DetermineAddOrSubtract();
-
-		FfsERSystemAssuranceReportLineDetailPtr padtReportLineDetail = CreateNewReportLineDetail(padtReportLine, padtCell);
-	}
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::DetermineGLFactory(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
-												  FfsERSystemAssuranceDefinitionColumnPtr padtColumn, FfsERSystemAssuranceDefinitionCellPtr padtCell)
-{
-	AmsManyRelationPtr padtColumnDimensions = padtColumn->GetColumnDimensionStrip();
-	AmsManyRelationPtr padtCellDimensions = padtCell->GetDimensionStrip();
-
-	if(padtParameterGroup->GetFiscalMonth().isNull() && padtParameterGroup->GetFiscalQuarter().isNull) // annual
-	{
-        if(ShouldDistributionTableBeUsed(padtColumnDimensions, padtCellDimensions))
-		{
-			padtParameterGroup->SetFactory(GetPOFactory(FfsGLAcctAnnualBalByDist));
-           padtParameterGroup->SetDetalFactory(GetPOFactory(FfsGLAcctAnnualBalByDist));
-		}
-		else
-		{
-			padtParameterGroup->SetFactory(GetPOFactory(FfsGLAcctAnnualBalByFund));
-           padtParameterGroup->SetDetalFactory(GetPOFactory(FfsGLAcctAnnualBalByFund));
-	}
-	else
-	{
-       if(ShouldDistributionTableBeUsed(padtColumnDimensions, padtCellDimensions))
-		{
-			padtParameterGroup->SetFactory(GetPOFactory(FfsGLAcctPeriodicBalByDist));
-          padtParameterGroup->SetDetalFactory(GetPOFactory(FfsGLAcctPeriodicBalByDist));
-		}
-		else
-		{
-          padtParameterGroup->SetFactory(GetPOFactory(FfsGLAcctPeriodicBalByFund));
-          padtParameterGroup->SetDetalFactory(GetPOFactory(FfsGLAcctPeriodicBalByFund));
-    }
-}
-
-AmsBoolean
-FfsERSystemAssuranceProcessor::ShouldDistributionTableBeUsed(AmsManyRelationPtr padtColumnDimensions, 
-                                                             AmsManyRelationPtr padtCellDimensions)
-{
-   // This method iterates through the column and cell dimension strips to see if anything other than fund
-   // dimensions have been entered.  If so, it returns TRUE indicating that a GL Rollup Distribution table
-   // should be used for the GL Factory.
-   for(AmsInt i = 0; i < padtColumnDimensions->Size(); i++)
-   {
-      FfsERSystemAssuranceDefinitionColumnDimensionStripPtr padtColumnStrip = padtColumn->GetColumnDimensionStrip(i);
-      FfsDimensionStripWithRollups& adtRollupStrip = padtColumnStrip->GetDimensionStrip();
-
-      deque < FfsDimensionReferencePtr > & adtDimensionStripDeque = adtRollupStrip.GetCompleteReferences();
-      deque < FfsDimensionReferencePtr > ::iterator adtDimensionStripIterator = adtDimensionStripDeque.begin();
-      FfsPartitionReference adtPartitionRef;
-      FfsFundReference adtFundRef;
-
-      for( ; adtDimensionStripIterator != adtDimensionStripDeque.end(); adtDimensionStripIterator++)
-      {
-         FfsDimensionReferencePtr padtDimension = (*adtDimensionStripIterator);
-
-         if((padtDimension->GetLabel() != adtPartitionRef.GetLabel() || padtDimension->GetLabel() != adtFundRef.GetLabel()) &&
-             padtDimension->GetCodeAspect().GetValue())
-         {
-            return TRUE;
-		}
-	}
-}
-
-   for(AmsInt i = 0; i < padtCellDimensions->Size; i++)
-   {
-      FfsERSystemAssuranceDefinitionCellDimensionStripPtr padtCellStrip = 
-         (FfsERSystemAssuranceDefinitionCellDimensionStripPtr)padtCell->GetDimensionStrip(i);
-      FfsDimensionStripWithRollups& adtRollupStrip = padtCellStrip->GetDimensionStrip();
-
-      deque < FfsDimensionReferencePtr > & adtDimensionStripDeque = adtRollupStrip.GetCompleteReferences();
-      deque < FfsDimensionReferencePtr > ::iterator adtDimensionStripIterator = adtDimensionStripDeque.begin();
-      FfsPartitionReference adtPartitionRef;
-      FfsFundReference adtFundRef;
-
-      for( ; adtDimensionStripIterator != adtDimensionStripDeque.end(); adtDimensionStripIterator++)
-      {
-         FfsDimensionReferencePtr padtDimension = (*adtDimensionStripIterator);
-
-         if((padtDimension->GetLabel() != adtPartitionRef.GetLabel() || padtDimension->GetLabel() != adtFundRef.GetLabel()) &&
-             padtDimension->GetCodeAspect().GetValue())
-         {
-            return TRUE;
-         }
-      }
-   }
-
-   return FALSE;
-}
-
-AmsString
-FfsERSystemAssuranceProcessor::ConvertToPartitionCode(strPartitionId)
-{
-	FfsPartitionReference adtPartition;
-	adtPartition.SetIdentityAspect(strPartitionId);
-	adtPartition.AsIdentity();
-
-	return adtPartition.GetPartitionObj().GetCode().GetValue();
-}
-
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddToCriterionIfNotNull(AmsDBCriterion& adtCriterion, AmsTableMapPtr padtTable, 
-                        const AmsString& strColumnName, const AmsSting& strValue, const AmsBoolean& bInclude)
-{
-	if(!strValue.isNull())
-		AddToCriterion(adtCriterion, padtTable->GetTable()[strColumnName], strValue), bInclude);
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::AddDimensionStripCriterion(FfsExternalReportAbstractDefinitionDimensionStripPtr padtDimStrip,
-														  deque<AmsCriterion> &adtDeque, const AmsBoolean& bInclude, AmsTableMapPtr padtTable)
-{
-	AmsDBCriterion adtCriterion;
-
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "TSYM", padtDimStrip->GetTreasurySymbol().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "PATN", padtDimStrip->GetDimensionStrip().GetPartition().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "BBFY", padtDimStrip->GetDimensionStrip().GetBegBudgetFY().GetValue(), bInclude);
-
-    AmsDBColumn adtEBFYColumn = padtTable->GetTable()["EBFY"];
-
-    if(padtDimStrip->GetDimensionStrip().GetEndBudgetFY().GetValue().isNull())
-    {
-        if(bInclude)
-           adtCriterion = adtCriterion && adtEBFYColumn.isNull();
-        else
-           adtCriterion = adtCriterion || !adtEBFYColumn.isNull();
-    }
-
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "EBFY", padtDimStrip->GetDimensionStrip().GetEndBudgetFY().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "FUND", padtDimStrip->GetDimensionStrip().GetFund().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "DIV", padtDimStrip->GetDimensionStrip().GetDivision().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "ORGN", padtDimStrip->GetDimensionStrip().GetOrganization().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "SUB_ORGN", padtDimStrip->GetDimensionStrip().GetSubOrganization().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "PROG", padtDimStrip->GetDimensionStrip().GetProgram().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "PROJ", padtDimStrip->GetDimensionStrip().GetProject().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "SUB_PROJ", padtDimStrip->GetDimensionStrip().GetSubProject().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "ACTY", padtDimStrip->GetDimensionStrip().GetActivity().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "BDOB", padtDimStrip->GetDimensionStrip().GetBudgetObject().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "SBOB", padtDimStrip->GetDimensionStrip().GetSubBudgetObject().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "REV_SRCE", padtDimStrip->GetDimensionStrip().GetRevenueSource().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "SREV_SRCE", padtDimStrip->GetDimensionStrip().GetSubRevenueSource().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM1", padtDimStrip->GetDimensionStrip().GetUserDimension1().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM2", padtDimStrip->GetDimensionStrip().GetUserDimension2().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM3", padtDimStrip->GetDimensionStrip().GetUserDimension3().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM4", padtDimStrip->GetDimensionStrip().GetUserDimension4().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM5", padtDimStrip->GetDimensionStrip().GetUserDimension5().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM6", padtDimStrip->GetDimensionStrip().GetUserDimension6().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM7", padtDimStrip->GetDimensionStrip().GetUserDimension7().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM8", padtDimStrip->GetDimensionStrip().GetUserDimension8().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM9", padtDimStrip->GetDimensionStrip().GetUserDimension9().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM10", padtDimStrip->GetDimensionStrip().GetUserDimension10().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "REIM_BDOB", padtDimStrip->GetDimensionStrip().GetReimbBudgetObject().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "REIM_SBOB", padtDimStrip->GetDimensionStrip().GetReimbSubBudgetObject().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "CAND_BBFY", padtDimStrip->GetDimensionStrip().GetClosedBegBudgetFY().GetValue(), bInclude);
-
-    AmsDBColumn adtClosedEBFYColumn = padtTable->GetTable()["CAND_EBFY"];
-
-    if(padtDimStrip->GetDimensionStrip().GetClosedEndBudgetFY().GetValue().isNull())
-    {
-       if(bInclude)
-          adtCriterion = adtCriterion && adtClosedEBFYColumn.isNull();
-       else
-          adtCriterion = adtCriterion || !adtClosedEBFYColumn.isNull();
-    }
-
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "CAND_EBFY", padtDimStrip->GetDimensionStrip().GetClosedEndBudgetFY().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, "CAND_FUND", padtDimStrip->GetDimensionStrip().GetClosedFund().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "COST_ORGN", padtDimStrip->GetDimensionStrip().GetCostOrganization().GetValue(), bInclude);
-	AddToCriterionIfNotNull(adtCriterion, padtTable, "SCST_ORGN", padtDimStrip->GetDimensionStrip().GetSubCostOrganization().GetValue(), bInclude);
-
-	adtDeque.push_back(adtCriterion);
-}
-
-AmsVoid
-FfsERSystemAssuranceProcessor::HandleDisplayDiscrepancies(FfsERSystemAssuranceReportPtr padtNewReport)
-{
-	if(!mbDisplayDiscrepanciesOnlyFlag)
-		return;
-
-	for(AmsInt i = 0; i < madtERSystemAssuranceDefinition->ColumnCount(); i++)
-	{
-		FfsERSystemAssuranceDefinitionColumnPtr padtColumn = (FfsERSystemAssuranceDefinitionColumnPtr) madtERSystemAssuranceDefinition->GetColumn(i);
-
-		if(padtColumn->GetAmountsLiteralsIndicator().GetValue() == FfsExternalReportAbstractDefinitionColumn::TOTAL)
-			{
-				
-		}
-	}
+#include FfsERSystemAssuranceProcessor.h
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <queue>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+// Static consts
+const AmsString FfsERSystemAssuranceProcessor::BAL = "BAL";
+const AmsString FfsERSystemAssuranceProcessor::NEW = "NEW";
+const AmsString FfsERSystemAssuranceProcessor::LINE_SEQUENCE_COLUMN = "ERSA_LINE_SEQ";
+const AmsString FfsERSystemAssuranceProcessor::GROUP_INDEX_COLUMN = "ERSA_GROUP_IDX";
+const AmsInt FfsERSystemAssuranceProcessor::DEFAULT_SAVE_BATCH_SIZE = 500;
+const AmsInt FfsERSystemAssuranceProcessor::DEFAULT_WRITE_QUEUE_SIZE = 4096;
+const AmsInt FfsERSystemAssuranceProcessor::DEFAULT_SLOW_QUERY_THRESHOLD = 1000;
+
+AmsString mstrERSystemAssuranceCode;
+FfsERSystemAssuranceDefinitionPtr madtERSystemAssuranceDefinition;
+AmsBoolean mbDisplayDiscrepanciesOnlyFlag;
+AmsBoolean mbComplexParameterEntered = FALSE;
+AmsBoolean mbColumnMajorExtraction = FALSE;
+AmsBoolean mbSemiJoinCriteria = FALSE;
+AmsBoolean mbProjectedRowDecode = FALSE;
+AmsBoolean mbRefreshFactsAttributes = FALSE;
+AmsString mstrTraceFile;
+AmsString mstrSlowQueryLogFile;
+AmsString mstrRecordCellsFile;
+AmsString mstrReplayCellsFile;
+AmsInt miSlowQueryThreshold = FfsERSystemAssuranceProcessor::DEFAULT_SLOW_QUERY_THRESHOLD;
+
+map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>> madtColumnParameters;
+AmsInt miSaveBatchSize = FfsERSystemAssuranceProcessor::DEFAULT_SAVE_BATCH_SIZE;
+AmsInt miWriteQueueSize = FfsERSystemAssuranceProcessor::DEFAULT_WRITE_QUEUE_SIZE;
+
+// Parallel line processing.  Each worker reads through its own connection and works on its own copy
+// of the column parameter groups, because DetermineGLFactory switches the factories per cell.
+AmsInt miLineWorkerCount = 1;
+thread_local AmsDBReadOnlyConnectionPtr mpadtWorkerConnection = NULL;
+thread_local map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>* mpadtWorkerColumnParameters = NULL;
+
+// Quoted and escaped JSON string value
+AmsString
+FfsERSystemAssuranceJsonString(const AmsString& strValue)
+{
+	AmsString strReturn = "\"";
+
+	for(size_t i = 0; i < strValue.length(); i++)
+	{
+		unsigned char cValue = strValue.data()[i];
+
+		// Control characters would end a line of the JSONL logs, so they are all escaped
+		if(cValue == '"' || cValue == '\\')
+			strReturn += AmsString("\\") + AmsString((char) cValue);
+		else if(cValue == '\n')
+			strReturn += "\\n";
+		else if(cValue == '\r')
+			strReturn += "\\r";
+		else if(cValue == '\t')
+			strReturn += "\\t";
+		else if(cValue < 0x20)
+		{
+			char acEscape[8];
+			snprintf(acEscape, sizeof(acEscape), "\\u%04x", cValue);
+			strReturn += acEscape;
+		}
+		else
+			strReturn += AmsString((char) cValue);
+	}
+
+	return strReturn + "\"";
+}
+
+// Predicates and IN-list members added while one reader's selector is built
+struct FfsERSystemAssuranceCriteriaSize
+{
+	long iPredicates;
+	long iInListMembers;
+};
+
+thread_local FfsERSystemAssuranceCriteriaSize madtCriteriaSize = { 0, 0 };
+
+// Query of the last reader opened by this thread, picked up by the column reader that wraps it
+thread_local AmsString mstrLastQuerySQL;
+thread_local long long miLastQueryOpenMicroseconds = 0;
+
+// Cost of one source reader, written to the slow-query log when it is destroyed
+struct FfsERSystemAssuranceQueryLogEntry
+{
+	AmsString strDefinitionCode;
+	AmsString strReportType;
+	AmsString strLines;
+	AmsInt iColumn;
+	AmsString strSQL;
+	FfsERSystemAssuranceCriteriaSize adtCriteriaSize;
+	long long iOpenMicroseconds;
+	long long iFirstRowMicroseconds;
+	long long iFetchMicroseconds;
+	long iRows;
+};
+
+// Opt-in log of the readers whose open and fetch time reach a threshold, one JSON object per line
+class FfsERSystemAssuranceSlowQueryLog
+{
+public:
+	FfsERSystemAssuranceSlowQueryLog()
+		: mbEnabled(FALSE), miThresholdMicroseconds(0)
+	{
+	}
+
+	AmsBoolean IsEnabled() const
+	{
+		return mbEnabled;
+	}
+
+	AmsBoolean Open(const AmsString& strFileName, AmsInt iThresholdMilliseconds)
+	{
+		madtFile.open((const char*)strFileName, ios::out | ios::app);
+		mbEnabled = madtFile.good();
+		miThresholdMicroseconds = (long long)iThresholdMilliseconds * 1000;
+		return mbEnabled;
+	}
+
+	AmsVoid Close()
+	{
+		mbEnabled = FALSE;
+
+		if(madtFile.is_open())
+			madtFile.close();
+	}
+
+	AmsVoid Write(const FfsERSystemAssuranceQueryLogEntry& adtEntry)
+	{
+		if(adtEntry.iOpenMicroseconds + adtEntry.iFetchMicroseconds < miThresholdMicroseconds)
+			return;
+
+		lock_guard<mutex> adtLock(madtFileMutex);
+
+		madtFile << "{\"definitionCode\":" << (const char*)FfsERSystemAssuranceJsonString(adtEntry.strDefinitionCode)
+			<< ",\"reportType\":" << (const char*)FfsERSystemAssuranceJsonString(adtEntry.strReportType)
+			<< ",\"lines\":" << (const char*)FfsERSystemAssuranceJsonString(adtEntry.strLines)
+			<< ",\"column\":" << adtEntry.iColumn
+			<< ",\"predicates\":" << adtEntry.adtCriteriaSize.iPredicates
+			<< ",\"inListMembers\":" << adtEntry.adtCriteriaSize.iInListMembers
+			<< ",\"timeToFirstRowMs\":" << (adtEntry.iOpenMicroseconds + adtEntry.iFirstRowMicroseconds) / 1000
+			<< ",\"fetchMs\":" << adtEntry.iFetchMicroseconds / 1000
+			<< ",\"rows\":" << adtEntry.iRows
+			<< ",\"sql\":" << (const char*)FfsERSystemAssuranceJsonString(adtEntry.strSQL) << "}" << endl;
+	}
+
+private:
+	AmsBoolean mbEnabled;
+	long long miThresholdMicroseconds;
+	mutex madtFileMutex;
+	ofstream madtFile;
+};
+
+FfsERSystemAssuranceSlowQueryLog madtSlowQueryLog;
+
+// Selector hash keying the recorded cell streams (64-bit FNV-1a of the rendered SQL)
+unsigned long long
+FfsERSystemAssuranceSelectorHash(const AmsString& strSQL)
+{
+	unsigned long long iHash = 14695981039346656037ull;
+	const char* pcValue = strSQL.data();
+
+	for(size_t i = 0; i < strSQL.length(); i++)
+	{
+		iHash ^= (unsigned char)pcValue[i];
+		iHash *= 1099511628211ull;
+	}
+
+	return iHash;
+}
+
+// Decoded source row: the cell detail fields the builders fill in besides the line and column
+struct FfsERSystemAssuranceCellRecord
+{
+	AmsString strPartition;
+	AmsString strFundId;
+	AmsString strTreasurySymbolId;
+	AmsString strTradingPartnerId;
+	AmsString strTradingPartner;
+	AmsString strFactsFundGroup;
+	AmsString strLinkId;
+	double dAmount;
+};
+
+// Cell streams of a run, keyed by line, column and selector hash.  When recording, the cells each column reader
+// decodes are collected and written to a binary file at the end of the run; a reader without cells for a line
+// still records an empty stream.  When replaying, the file is loaded before the run and the column readers
+// serve the recorded cells instead of querying the source tables.  A reader whose stream is not in the file
+// was built from a different definition or parameters, and is remembered so the run can report it.
+// The state belongs to one run: it is reset when the parameters are validated and after the run.
+class FfsERSystemAssuranceCellStreams
+{
+public:
+	FfsERSystemAssuranceCellStreams()
+		: mbRecording(FALSE), mbReplaying(FALSE)
+	{
+	}
+
+	AmsBoolean IsRecording() const
+	{
+		return mbRecording;
+	}
+
+	AmsBoolean IsReplaying() const
+	{
+		return mbReplaying;
+	}
+
+	AmsVoid Reset()
+	{
+		madtStreams.clear();
+		madtMissingStreams.clear();
+		mbRecording = FALSE;
+		mbReplaying = FALSE;
+	}
+
+	AmsVoid StartRecording()
+	{
+		madtStreams.clear();
+		mbRecording = TRUE;
+	}
+
+	// Makes sure the stream exists, so a reader without cells is recorded too
+	AmsVoid RecordEnd(const AmsString& strLineNumber, AmsInt iColumn, unsigned long long iSelectorHash)
+	{
+		lock_guard<mutex> adtLock(madtStreamsMutex);
+		madtStreams[GetKey(strLineNumber, iColumn, iSelectorHash)];
+	}
+
+	AmsVoid Record(const AmsString& strLineNumber, AmsInt iColumn, unsigned long long iSelectorHash,
+				   const FfsERSystemAssuranceCellRecord& adtRecord)
+	{
+		lock_guard<mutex> adtLock(madtStreamsMutex);
+		madtStreams[GetKey(strLineNumber, iColumn, iSelectorHash)].push_back(adtRecord);
+	}
+
+	// Cells recorded for the key, or NULL when the recording has no stream for it
+	const vector<FfsERSystemAssuranceCellRecord>* Find(const AmsString& strLineNumber, AmsInt iColumn, unsigned long long iSelectorHash)
+	{
+		map<AmsString, vector<FfsERSystemAssuranceCellRecord>>::const_iterator it = madtStreams.find(GetKey(strLineNumber, iColumn, iSelectorHash));
+
+		if(it == madtStreams.end())
+		{
+			lock_guard<mutex> adtLock(madtStreamsMutex);
+			madtMissingStreams.insert(pair<AmsString, AmsInt>(strLineNumber, iColumn));
+			return NULL;
+		}
+
+		return &(*it).second;
+	}
+
+	// Line and column of every replayed reader that had no recorded stream
+	const set< pair<AmsString, AmsInt> >& GetMissingStreams() const
+	{
+		return madtMissingStreams;
+	}
+
+	AmsBoolean Write(const AmsString& strFileName)
+	{
+		ofstream adtFile((const char*)strFileName, ios::out | ios::binary | ios::trunc);
+
+		if(!adtFile.good())
+			return FALSE;
+
+		adtFile.write(MAGIC, sizeof(MAGIC));
+		WriteCount(adtFile, madtStreams.size());
+
+		map<AmsString, vector<FfsERSystemAssuranceCellRecord>>::const_iterator it = madtStreams.begin();
+
+		for( ; it != madtStreams.end(); it++)
+		{
+			WriteString(adtFile, (*it).first);
+			WriteCount(adtFile, (*it).second.size());
+
+			for(size_t i = 0; i < (*it).second.size(); i++)
+			{
+				const FfsERSystemAssuranceCellRecord& adtRecord = (*it).second[i];
+				WriteString(adtFile, adtRecord.strPartition);
+				WriteString(adtFile, adtRecord.strFundId);
+				WriteString(adtFile, adtRecord.strTreasurySymbolId);
+				WriteString(adtFile, adtRecord.strTradingPartnerId);
+				WriteString(adtFile, adtRecord.strTradingPartner);
+				WriteString(adtFile, adtRecord.strFactsFundGroup);
+				WriteString(adtFile, adtRecord.strLinkId);
+				adtFile.write((const char*)&adtRecord.dAmount, sizeof(adtRecord.dAmount));
+			}
+		}
+
+		return adtFile.good();
+	}
+
+	AmsBoolean Load(const AmsString& strFileName)
+	{
+		madtStreams.clear();
+		ifstream adtFile((const char*)strFileName, ios::in | ios::binary);
+		char acMagic[sizeof(MAGIC)];
+
+		if(!adtFile.read(acMagic, sizeof(acMagic)) || memcmp(acMagic, MAGIC, sizeof(MAGIC)))
+			return FALSE;
+
+		unsigned int iStreamCount = 0;
+
+		if(!ReadCount(adtFile, iStreamCount))
+			return FALSE;
+
+		for(unsigned int iStream = 0; iStream < iStreamCount; iStream++)
+		{
+			AmsString strKey;
+			unsigned int iCellCount = 0;
+
+			if(!ReadString(adtFile, strKey) || !ReadCount(adtFile, iCellCount))
+				return FALSE;
+
+			vector<FfsERSystemAssuranceCellRecord>& adtCells = madtStreams[strKey];
+			adtCells.resize(iCellCount);
+
+			for(unsigned int i = 0; i < iCellCount; i++)
+			{
+				FfsERSystemAssuranceCellRecord& adtRecord = adtCells[i];
+
+				if(!ReadString(adtFile, adtRecord.strPartition) || !ReadString(adtFile, adtRecord.strFundId) ||
+				   !ReadString(adtFile, adtRecord.strTreasurySymbolId) || !ReadString(adtFile, adtRecord.strTradingPartnerId) ||
+				   !ReadString(adtFile, adtRecord.strTradingPartner) || !ReadString(adtFile, adtRecord.strFactsFundGroup) ||
+				   !ReadString(adtFile, adtRecord.strLinkId) || !adtFile.read((char*)&adtRecord.dAmount, sizeof(adtRecord.dAmount)))
+					return FALSE;
+			}
+		}
+
+		mbReplaying = TRUE;
+		return TRUE;
+	}
+
+private:
+	static AmsString GetKey(const AmsString& strLineNumber, AmsInt iColumn, unsigned long long iSelectorHash)
+	{
+		char acHash[17];
+		snprintf(acHash, sizeof(acHash), "%016llx", iSelectorHash);
+		return strLineNumber + "|" + AmsIntToStr(iColumn) + "|" + acHash;
+	}
+
+	static AmsVoid WriteCount(ofstream& adtFile, unsigned int iCount)
+	{
+		adtFile.write((const char*)&iCount, sizeof(iCount));
+	}
+
+	static AmsVoid WriteString(ofstream& adtFile, const AmsString& strValue)
+	{
+		WriteCount(adtFile, strValue.length());
+		adtFile.write(strValue.data(), strValue.length());
+	}
+
+	static AmsBoolean ReadCount(ifstream& adtFile, unsigned int& iCount)
+	{
+		return adtFile.read((char*)&iCount, sizeof(iCount)) ? TRUE : FALSE;
+	}
+
+	static AmsBoolean ReadString(ifstream& adtFile, AmsString& strValue)
+	{
+		unsigned int iLength = 0;
+
+		if(!ReadCount(adtFile, iLength))
+			return FALSE;
+
+		string strBuffer(iLength, '\0');
+
+		if(iLength && !adtFile.read(&strBuffer[0], iLength))
+			return FALSE;
+
+		strValue = strBuffer.c_str();
+		return TRUE;
+	}
+
+	static const char MAGIC[8];
+
+	AmsBoolean mbRecording;
+	AmsBoolean mbReplaying;
+	mutex madtStreamsMutex;
+	map<AmsString, vector<FfsERSystemAssuranceCellRecord>> madtStreams;
+	set< pair<AmsString, AmsInt> > madtMissingStreams;
+};
+
+// Recordings of the first format had no empty streams, so a missing stream did not mean a changed selector
+const char FfsERSystemAssuranceCellStreams::MAGIC[8] = { 'E', 'R', 'S', 'A', 'C', 'E', 'L', '2' };
+
+FfsERSystemAssuranceCellStreams madtCellStreams;
+
+// Selector hash of the last reader opened by this thread, kept on the column reader that wraps it
+thread_local unsigned long long miLastSelectorHash = 0;
+
+// Source reader for one report column.  In line-major mode there is one of these per line and column.
+// In column-major mode a single reader covers every AMOUNT line of the definition, each row is tagged
+// with the sequence of the line it satisfies, and the rows are handed out one line at a time.
+// A replaying column reader has no source reader and serves the cells recorded for its selector.
+class FfsERSystemAssuranceColumnReader
+{
+public:
+	FfsERSystemAssuranceColumnReader(AmsReaderPtr padtReader, AmsBoolean bLineTagged)
+		: mpadtReader(padtReader), mbLineTagged(bLineTagged), mbRowPending(FALSE), miPendingLineSequence(-1), mpadtQueryLogEntry(NULL),
+		  miSelectorHash(0), mpadtReplayCells(NULL), miReplayPosition(0)
+	{
+	}
+
+	~FfsERSystemAssuranceColumnReader()
+	{
+		delete mpadtReader;
+
+		if(mpadtQueryLogEntry)
+		{
+			madtSlowQueryLog.Write(*mpadtQueryLogEntry);
+			delete mpadtQueryLogEntry;
+		}
+	}
+
+	// Takes ownership of the entry; the reader's fetches are timed from now on
+	AmsVoid SetQueryLogEntry(FfsERSystemAssuranceQueryLogEntry* padtEntry)
+	{
+		mpadtQueryLogEntry = padtEntry;
+	}
+
+	AmsReaderPtr GetReader()
+	{
+		return mpadtReader;
+	}
+
+	unsigned long long GetSelectorHash() const
+	{
+		return miSelectorHash;
+	}
+
+	AmsVoid SetSelectorHash(unsigned long long iSelectorHash)
+	{
+		miSelectorHash = iSelectorHash;
+	}
+
+	// Next recorded cell of the line and column, or NULL once the line has no more cells
+	const FfsERSystemAssuranceCellRecord* NextReplayedCell(const AmsString& strLineNumber, AmsInt iColumn)
+	{
+		if(strLineNumber != mstrReplayLineNumber)
+		{
+			mstrReplayLineNumber = strLineNumber;
+			mpadtReplayCells = madtCellStreams.Find(strLineNumber, iColumn, miSelectorHash);
+			miReplayPosition = 0;
+		}
+
+		if(!mpadtReplayCells || miReplayPosition >= mpadtReplayCells->size())
+			return NULL;
+
+		return &(*mpadtReplayCells)[miReplayPosition++];
+	}
+
+	// Positions the reader on its next row for the given line.  Returns FALSE once the line has no more rows,
+	// leaving any row that belongs to a later line pending for that line.
+	AmsBoolean NextRow(AmsInt iLineSequence)
+	{
+		if(!mpadtReader)
+			return FALSE;
+
+		if(!mbLineTagged)
+			return FetchRow();
+
+		while(!mbRowPending || miPendingLineSequence < iLineSequence)
+		{
+			if(!FetchRow())
+			{
+				mbRowPending = FALSE;
+				return FALSE;
+			}
+
+			mbRowPending = TRUE;
+			miPendingLineSequence = AmsStrToInteger(mpadtReader->GetColumnValue(FfsERSystemAssuranceProcessor::LINE_SEQUENCE_COLUMN));
+		}
+
+		if(miPendingLineSequence != iLineSequence)
+			return FALSE;
+
+		mbRowPending = FALSE;
+		return TRUE;
+	}
+
+private:
+	AmsBoolean FetchRow()
+	{
+		if(!mpadtQueryLogEntry)
+			return mpadtReader->NextRow();
+
+		chrono::steady_clock::time_point adtStart = chrono::steady_clock::now();
+		AmsBoolean bRow = mpadtReader->NextRow();
+		long long iMicroseconds = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - adtStart).count();
+
+		if(!mpadtQueryLogEntry->iRows && !mpadtQueryLogEntry->iFetchMicroseconds)
+			mpadtQueryLogEntry->iFirstRowMicroseconds = iMicroseconds;
+
+		mpadtQueryLogEntry->iFetchMicroseconds += iMicroseconds;
+
+		if(bRow)
+			mpadtQueryLogEntry->iRows++;
+
+		return bRow;
+	}
+
+	AmsReaderPtr mpadtReader;
+	AmsBoolean mbLineTagged;
+	AmsBoolean mbRowPending;
+	AmsInt miPendingLineSequence;
+	FfsERSystemAssuranceQueryLogEntry* mpadtQueryLogEntry;
+	unsigned long long miSelectorHash;
+	AmsString mstrReplayLineNumber;
+	const vector<FfsERSystemAssuranceCellRecord>* mpadtReplayCells;
+	size_t miReplayPosition;
+};
+
+typedef FfsERSystemAssuranceColumnReader* FfsERSystemAssuranceColumnReaderPtr;
+
+// Rows read and written for one report line, by column, and the time spent fetching rows and building cells.
+// Kept locally while the line is processed and added to the run statistics once it is done, so the per-row
+// phases never touch the shared counters.
+struct FfsERSystemAssuranceLineCounters
+{
+	FfsERSystemAssuranceLineCounters()
+		: iLineDetailsWritten(0), iRowFetchNanoseconds(0), iRowFetches(0), iCellBuildNanoseconds(0), iCellBuilds(0)
+	{
+	}
+
+	map<AmsInt, long, less<AmsInt>> adtRowsRead;
+	map<AmsInt, long, less<AmsInt>> adtRowsWritten;
+	long iLineDetailsWritten;
+	long long iRowFetchNanoseconds;
+	long iRowFetches;
+	long long iCellBuildNanoseconds;
+	long iCellBuilds;
+};
+
+// Times a per-row phase into a line's counters.  Every call is counted but only one in SAMPLE_INTERVAL reads
+// the clock, and its time is scaled up to stand for the calls in between.
+class FfsERSystemAssuranceSampledTimer
+{
+public:
+	static const long SAMPLE_INTERVAL = 16;
+
+	FfsERSystemAssuranceSampledTimer(long long& iNanoseconds, long& iCalls)
+		: mpiNanoseconds(&iNanoseconds), mbSampled(iCalls++ % SAMPLE_INTERVAL == 0)
+	{
+		if(mbSampled)
+			madtStart = chrono::steady_clock::now();
+	}
+
+	~FfsERSystemAssuranceSampledTimer()
+	{
+		if(mbSampled)
+			*mpiNanoseconds += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - madtStart).count() * SAMPLE_INTERVAL;
+	}
+
+private:
+	long long* mpiNanoseconds;
+	AmsBoolean mbSampled;
+	chrono::steady_clock::time_point madtStart;
+};
+
+// Wall time and call counts per phase of an assurance run, plus row counts per line and per column, summarised
+// as JSON in the job log at the end of Process().  Phases may nest: a reader is opened inside OpenLineReaders and
+// a cell is built inside a row fetch's caller, so the phase times do not add up to the run time.
+class FfsERSystemAssuranceRunStatistics
+{
+public:
+	enum Phase
+	{
+		RUN,
+		VALIDATION,
+		READERS,
+		READER_OPEN,
+		ROW_FETCH,
+		CELL_BUILD,
+		SAVE,
+		TOTALS,
+		ROUNDING,
+		DISCREPANCIES,
+		PHASE_COUNT
+	};
+
+	FfsERSystemAssuranceRunStatistics()
+	{
+		Reset();
+	}
+
+	AmsVoid Reset()
+	{
+		for(AmsInt i = 0; i < PHASE_COUNT; i++)
+		{
+			miPhaseNanoseconds[i].store(0);
+			miPhaseCalls[i].store(0);
+		}
+
+		lock_guard<mutex> adtLock(madtCountsMutex);
+		madtLineCounts.clear();
+		madtColumnCounts.clear();
+	}
+
+	AmsVoid AddPhase(Phase ePhase, long long iNanoseconds, long iCalls = 1)
+	{
+		miPhaseNanoseconds[ePhase].fetch_add(iNanoseconds, memory_order_relaxed);
+		miPhaseCalls[ePhase].fetch_add(iCalls, memory_order_relaxed);
+	}
+
+	AmsVoid AddLine(const AmsString& strLineNumber, const FfsERSystemAssuranceLineCounters& adtCounters)
+	{
+		lock_guard<mutex> adtLock(madtCountsMutex);
+		Counts& adtLineCounts = madtLineCounts[strLineNumber];
+		map<AmsInt, long, less<AmsInt>>::const_iterator it;
+
+		for(it = adtCounters.adtRowsRead.begin(); it != adtCounters.adtRowsRead.end(); it++)
+		{
+			adtLineCounts.iRowsRead += (*it).second;
+			madtColumnCounts[(*it).first].iRowsRead += (*it).second;
+		}
+
+		for(it = adtCounters.adtRowsWritten.begin(); it != adtCounters.adtRowsWritten.end(); it++)
+		{
+			adtLineCounts.iRowsWritten += (*it).second;
+			madtColumnCounts[(*it).first].iRowsWritten += (*it).second;
+		}
+
+		// Line details belong to the line, not to a column
+		adtLineCounts.iRowsWritten += adtCounters.iLineDetailsWritten;
+
+		AddPhase(ROW_FETCH, adtCounters.iRowFetchNanoseconds, adtCounters.iRowFetches);
+		AddPhase(CELL_BUILD, adtCounters.iCellBuildNanoseconds, adtCounters.iCellBuilds);
+	}
+
+	AmsString ToJson(long iReferenceCacheHits, long iReferenceCacheMisses)
+	{
+		static const char* apcPhaseNames[] = { "run", "validation", "readers", "readerOpen", "rowFetch", "cellBuild",
+			"save", "totals", "rounding", "discrepancies" };
+
+		AmsString strJson = "{\"phases\":{";
+
+		for(AmsInt i = 0; i < PHASE_COUNT; i++)
+		{
+			strJson += AmsString(i ? "," : "") + "\"" + apcPhaseNames[i] + "\":{\"ms\":" +
+				AmsIntToStr(miPhaseNanoseconds[i].load() / 1000000) + ",\"calls\":" + AmsIntToStr(miPhaseCalls[i].load()) + "}";
+		}
+
+		strJson += "},\"referenceCache\":{\"hits\":" + AmsIntToStr(iReferenceCacheHits) + ",\"misses\":" + AmsIntToStr(iReferenceCacheMisses) + "}";
+
+		lock_guard<mutex> adtLock(madtCountsMutex);
+		strJson += ",\"lines\":[";
+
+		for(map<AmsString, Counts, less<AmsString>>::iterator it = madtLineCounts.begin(); it != madtLineCounts.end(); it++)
+		{
+			strJson += AmsString(it != madtLineCounts.begin() ? "," : "") + "{\"line\":" + FfsERSystemAssuranceJsonString((*it).first) +
+				",\"rowsRead\":" + AmsIntToStr((*it).second.iRowsRead) + ",\"rowsWritten\":" + AmsIntToStr((*it).second.iRowsWritten) + "}";
+		}
+
+		strJson += "],\"columns\":[";
+
+		for(map<AmsInt, Counts, less<AmsInt>>::iterator it = madtColumnCounts.begin(); it != madtColumnCounts.end(); it++)
+		{
+			strJson += AmsString(it != madtColumnCounts.begin() ? "," : "") + "{\"column\":" + AmsIntToStr((*it).first) +
+				",\"rowsRead\":" + AmsIntToStr((*it).second.iRowsRead) + ",\"rowsWritten\":" + AmsIntToStr((*it).second.iRowsWritten) + "}";
+		}
+
+		strJson += "]}";
+		return strJson;
+	}
+
+private:
+	struct Counts
+	{
+		Counts()
+			: iRowsRead(0), iRowsWritten(0)
+		{
+		}
+
+		long iRowsRead;
+		long iRowsWritten;
+	};
+
+	atomic<long long> miPhaseNanoseconds[PHASE_COUNT];
+	atomic<long> miPhaseCalls[PHASE_COUNT];
+	mutex madtCountsMutex;
+	map<AmsString, Counts, less<AmsString>> madtLineCounts;
+	map<AmsInt, Counts, less<AmsInt>> madtColumnCounts;
+};
+
+FfsERSystemAssuranceRunStatistics madtRunStatistics;
+
+// Adds the wall time of its scope to a phase of the run statistics
+class FfsERSystemAssurancePhaseTimer
+{
+public:
+	FfsERSystemAssurancePhaseTimer(FfsERSystemAssuranceRunStatistics::Phase ePhase)
+		: mePhase(ePhase), madtStart(chrono::steady_clock::now())
+	{
+	}
+
+	~FfsERSystemAssurancePhaseTimer()
+	{
+		madtRunStatistics.AddPhase(mePhase, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - madtStart).count());
+	}
+
+private:
+	FfsERSystemAssuranceRunStatistics::Phase mePhase;
+	chrono::steady_clock::time_point madtStart;
+};
+
+// Optional timeline of a run, written as a Chrome trace-event file.  Every thread records its spans into its
+// own buffer, so the line workers and the writer thread never wait on each other while tracing.
+class FfsERSystemAssuranceTracer
+{
+public:
+	FfsERSystemAssuranceTracer()
+		: mbEnabled(FALSE), miGeneration(0), miNextThreadId(0)
+	{
+	}
+
+	~FfsERSystemAssuranceTracer()
+	{
+		Stop();
+	}
+
+	AmsBoolean IsEnabled() const
+	{
+		return mbEnabled.load(memory_order_relaxed);
+	}
+
+	AmsVoid Start()
+	{
+		Stop();
+
+		madtStart = chrono::steady_clock::now();
+		miGeneration++;
+		mbEnabled.store(TRUE);
+	}
+
+	// Drops the recorded events
+	AmsVoid Stop()
+	{
+		mbEnabled.store(FALSE);
+
+		lock_guard<mutex> adtLock(madtBuffersMutex);
+		release(madtBuffers.begin(), madtBuffers.end());
+		madtBuffers.clear();
+	}
+
+	long long Now() const
+	{
+		return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - madtStart).count();
+	}
+
+	AmsVoid AddSpan(const char* pcName, long long iStart, long long iEnd, const AmsString& strLineNumber, AmsInt iColumn)
+	{
+		Event adtEvent;
+		adtEvent.pcName = pcName;
+		adtEvent.iStart = iStart;
+		adtEvent.iDuration = iEnd - iStart;
+		adtEvent.strLineNumber = strLineNumber;
+		adtEvent.iColumn = iColumn;
+
+		GetBuffer()->adtEvents.push_back(adtEvent);
+	}
+
+	// Only called once every traced thread is done with the run
+	AmsBoolean Write(const AmsString& strFileName)
+	{
+		ofstream adtFile((const char*)strFileName);
+
+		if(!adtFile)
+			return FALSE;
+
+		lock_guard<mutex> adtLock(madtBuffersMutex);
+		AmsBoolean bFirst = TRUE;
+
+		adtFile << "{\"traceEvents\":[";
+
+		for(AmsInt i = 0; i < madtBuffers.size(); i++)
+		{
+			deque<Event>& adtEvents = madtBuffers[i]->adtEvents;
+
+			for(AmsInt j = 0; j < adtEvents.size(); j++)
+			{
+				Event& adtEvent = adtEvents[j];
+
+				adtFile << (bFirst ? "" : ",") << "\n{\"name\":\"" << adtEvent.pcName << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+					<< madtBuffers[i]->iThreadId << ",\"ts\":" << adtEvent.iStart << ",\"dur\":" << adtEvent.iDuration << ",\"args\":{";
+
+				if(!adtEvent.strLineNumber.isNull())
+					adtFile << "\"line\":" << (const char*)FfsERSystemAssuranceJsonString(adtEvent.strLineNumber) << (adtEvent.iColumn >= 0 ? "," : "");
+
+				if(adtEvent.iColumn >= 0)
+					adtFile << "\"column\":" << adtEvent.iColumn;
+
+				adtFile << "}}";
+				bFirst = FALSE;
+			}
+		}
+
+		adtFile << "\n]}\n";
+		return adtFile.good();
+	}
+
+private:
+	struct Event
+	{
+		const char* pcName;
+		long long iStart;
+		long long iDuration;
+		AmsString strLineNumber;
+		AmsInt iColumn;
+	};
+
+	struct Buffer
+	{
+		AmsInt iThreadId;
+		deque<Event> adtEvents;
+	};
+
+	Buffer* GetBuffer()
+	{
+		static thread_local Buffer* padtBuffer = NULL;
+		static thread_local AmsInt iBufferGeneration = 0;
+
+		// A thread that outlives a run gets a fresh buffer in the next one.  The old buffer was freed with its
+		// run, so only the generation kept beside the pointer may be looked at before replacing it.
+		if(!padtBuffer || iBufferGeneration != miGeneration.load())
+		{
+			lock_guard<mutex> adtLock(madtBuffersMutex);
+
+			padtBuffer = new Buffer;
+			padtBuffer->iThreadId = ++miNextThreadId;
+			iBufferGeneration = miGeneration.load();
+			madtBuffers.push_back(padtBuffer);
+		}
+
+		return padtBuffer;
+	}
+
+	atomic<AmsBoolean> mbEnabled;
+	atomic<AmsInt> miGeneration;
+	AmsInt miNextThreadId;
+	chrono::steady_clock::time_point madtStart;
+	mutex madtBuffersMutex;
+	deque<Buffer*> madtBuffers;
+};
+
+FfsERSystemAssuranceTracer madtTracer;
+
+// Records one span of the timeline when tracing is on
+class FfsERSystemAssuranceTraceSpan
+{
+public:
+	FfsERSystemAssuranceTraceSpan(const char* pcName, const AmsString& strLineNumber = AmsString(), AmsInt iColumn = -1)
+		: mpcName(pcName), mbEnabled(madtTracer.IsEnabled()), miStart(0), miColumn(iColumn)
+	{
+		if(mbEnabled)
+		{
+			mstrLineNumber = strLineNumber;
+			miStart = madtTracer.Now();
+		}
+	}
+
+	~FfsERSystemAssuranceTraceSpan()
+	{
+		if(mbEnabled)
+			madtTracer.AddSpan(mpcName, miStart, madtTracer.Now(), mstrLineNumber, miColumn);
+	}
+
+private:
+	const char* mpcName;
+	AmsBoolean mbEnabled;
+	long long miStart;
+	AmsString mstrLineNumber;
+	AmsInt miColumn;
+};
+
+// Buffers new persistent objects of one type and writes them with array inserts once the batch is full.
+// A writer can be given the writer of the objects its objects point to; that one is always flushed first.
+// Objects still buffered when the writer goes away are released unsaved, so the last batch needs a Flush.
+class FfsERSystemAssuranceBatchWriter
+{
+public:
+	FfsERSystemAssuranceBatchWriter(AmsBaseFactory& adtFactory, AmsDBConnectionPtr padtConnection, AmsInt iBatchSize,
+		FfsERSystemAssuranceBatchWriter* padtParentWriter = NULL)
+		: madtFactory(adtFactory), mpadtConnection(padtConnection), miBatchSize(iBatchSize), mpadtParentWriter(padtParentWriter)
+	{
+	}
+
+	~FfsERSystemAssuranceBatchWriter()
+	{
+		release(madtObjects.begin(), madtObjects.end());
+	}
+
+	// Takes ownership of the object
+	AmsVoid Add(AmsPersistentObjectPtr padtObject)
+	{
+		madtObjects.push_back(padtObject);
+
+		if(madtObjects.size() >= miBatchSize)
+			Flush();
+	}
+
+	AmsVoid Flush()
+	{
+		if(mpadtParentWriter)
+			mpadtParentWriter->Flush();
+
+		if(!madtObjects.size())
+			return;
+
+		FfsERSystemAssurancePhaseTimer adtTimer(FfsERSystemAssuranceRunStatistics::SAVE);
+		FfsERSystemAssuranceTraceSpan adtSpan("insertBatch");
+		madtFactory.GetStorage()->InsertArray(madtObjects, mpadtConnection);
+		release(madtObjects.begin(), madtObjects.end());
+		madtObjects.clear();
+	}
+
+private:
+	AmsBaseFactory& madtFactory;
+	AmsDBConnectionPtr mpadtConnection;
+	AmsInt miBatchSize;
+	FfsERSystemAssuranceBatchWriter* mpadtParentWriter;
+	deque<AmsPersistentObjectPtr> madtObjects;
+};
+
+// Bounded FIFO queue.  It does no locking of its own; the writer only uses it under its mutex and waits on
+// its condition variables when the queue is full or empty.
+template <class T>
+class FfsERSystemAssuranceBoundedQueue
+{
+public:
+	FfsERSystemAssuranceBoundedQueue(AmsInt iCapacity)
+		: miCapacity(iCapacity > 0 ? iCapacity : 1)
+	{
+	}
+
+	// Returns FALSE when the queue is full
+	AmsBoolean TryPush(const T& adtValue)
+	{
+		if(madtValues.size() >= miCapacity)
+			return FALSE;
+
+		madtValues.push_back(adtValue);
+		return TRUE;
+	}
+
+	// Returns FALSE when the queue is empty
+	AmsBoolean TryPop(T& adtValue)
+	{
+		if(madtValues.empty())
+			return FALSE;
+
+		adtValue = madtValues.front();
+		madtValues.pop_front();
+		return TRUE;
+	}
+
+private:
+	size_t miCapacity;
+	deque<T> madtValues;
+};
+
+// Write-behind stage.  Extraction enqueues finished report objects and goes on reading while a dedicated
+// thread with its own connection writes them in batches.  A full queue blocks the producers and an empty one
+// the writer thread; both wait on condition variables rather than spinning.  Nothing is
+// committed by the thread: the report is saved on the same connection afterwards and Commit is called once
+// that has succeeded.  A writer that is destroyed without Commit, e.g. while an exception unwinds, stops the
+// thread without writing what is still queued and rolls the connection back.
+class FfsERSystemAssuranceWriter
+{
+public:
+	enum WriteType
+	{
+		LINE_DETAIL,
+		ACTIVITY,
+		PARAMETER_INFORMATION,
+		FLUSH
+	};
+
+	FfsERSystemAssuranceWriter(AmsInt iQueueSize, AmsInt iBatchSize)
+		: madtQueue(iQueueSize), miBatchSize(iBatchSize), mbFinished(FALSE), mbAborted(FALSE), mbCommitted(FALSE)
+	{
+		mpadtConnection = AmsDBConnectionManager::GetNewConnection();
+		madtThread = thread(&FfsERSystemAssuranceWriter::Run, this);
+	}
+
+	~FfsERSystemAssuranceWriter()
+	{
+		if(madtThread.joinable())
+		{
+			SetAndWake(mbAborted);
+			madtThread.join();
+		}
+
+		WriteRequest adtRequest;
+
+		while(madtQueue.TryPop(adtRequest))
+			release(adtRequest.padtObject);
+
+		if(!mbCommitted)
+			mpadtConnection->Rollback();
+
+		delete mpadtConnection;
+	}
+
+	// Takes ownership of the object.  Once the writer has failed, objects are released unwritten; the error
+	// is raised by Finish.
+	AmsVoid Enqueue(WriteType eType, AmsPersistentObjectPtr padtObject)
+	{
+		WriteRequest adtRequest;
+		adtRequest.eType = eType;
+		adtRequest.padtObject = padtObject;
+
+		unique_lock<mutex> adtLock(madtMutex);
+
+		while(!madtQueue.TryPush(adtRequest))
+		{
+			if(mbAborted.load(memory_order_acquire))
+			{
+				adtLock.unlock();
+				release(padtObject);
+				return;
+			}
+
+			madtNotFull.wait(adtLock);
+		}
+
+		adtLock.unlock();
+		madtNotEmpty.notify_one();
+	}
+
+	// Asks the writer to write everything it has buffered so far
+	AmsVoid Flush()
+	{
+		Enqueue(FLUSH, NULL);
+	}
+
+	// Barrier: returns once everything enqueued has been written, or throws what made the writer fail
+	AmsVoid Finish()
+	{
+		if(madtThread.joinable())
+		{
+			SetAndWake(mbFinished);
+			madtThread.join();
+		}
+
+		if(madtError)
+			rethrow_exception(madtError);
+	}
+
+	// The connection the details were written on; only to be used after Finish
+	AmsDBConnectionPtr GetConnection()
+	{
+		return mpadtConnection;
+	}
+
+	AmsVoid Commit()
+	{
+		FfsERSystemAssuranceTraceSpan adtSpan("commit");
+		mpadtConnection->Commit();
+		mbCommitted = TRUE;
+	}
+
+private:
+	struct WriteRequest
+	{
+		WriteType eType;
+		AmsPersistentObjectPtr padtObject;
+	};
+
+	AmsVoid SetAndWake(atomic<AmsBoolean>& bFlag)
+	{
+		{
+			lock_guard<mutex> adtLock(madtMutex);
+			bFlag.store(TRUE, memory_order_release);
+		}
+
+		madtNotEmpty.notify_all();
+		madtNotFull.notify_all();
+	}
+
+	// Waits for the next request.  Returns FALSE once the writer is aborted, or finished with the queue empty.
+	AmsBoolean Pop(WriteRequest& adtRequest)
+	{
+		unique_lock<mutex> adtLock(madtMutex);
+
+		for(;;)
+		{
+			if(mbAborted.load(memory_order_acquire))
+				return FALSE;
+
+			// Finish is only called once the producers are done, so an empty queue after
+			// the flag has been seen means everything has been taken
+			AmsBoolean bFinished = mbFinished.load(memory_order_acquire);
+
+			if(madtQueue.TryPop(adtRequest))
+				break;
+
+			if(bFinished)
+				return FALSE;
+
+			madtNotEmpty.wait(adtLock);
+		}
+
+		adtLock.unlock();
+		madtNotFull.notify_one();
+		return TRUE;
+	}
+
+	AmsVoid Run()
+	{
+		try
+		{
+			// Activity records point to line details, so the detail writer is flushed before the activity writer
+			FfsERSystemAssuranceBatchWriter adtDetailWriter(GetPOFactory(FfsERSystemAssuranceReportLineDetail), mpadtConnection, miBatchSize);
+			FfsERSystemAssuranceBatchWriter adtActivityWriter(GetPOFactory(FfsERSystemAssuranceReportActivity), mpadtConnection, miBatchSize, &adtDetailWriter);
+			FfsERSystemAssuranceBatchWriter adtParameterWriter(GetPOFactory(FfsERSystemAssuranceReportParameterInformation), mpadtConnection, miBatchSize);
+
+			WriteRequest adtRequest;
+
+			while(Pop(adtRequest))
+			{
+				if(adtRequest.eType == LINE_DETAIL)
+					adtDetailWriter.Add(adtRequest.padtObject);
+				else if(adtRequest.eType == ACTIVITY)
+					adtActivityWriter.Add(adtRequest.padtObject);
+				else if(adtRequest.eType == PARAMETER_INFORMATION)
+					adtParameterWriter.Add(adtRequest.padtObject);
+				else
+				{
+					FfsERSystemAssuranceTraceSpan adtSpan("flush");
+					adtActivityWriter.Flush();
+					adtParameterWriter.Flush();
+				}
+			}
+
+			if(mbAborted.load(memory_order_acquire))
+				return;
+
+			adtActivityWriter.Flush();
+			adtParameterWriter.Flush();
+		}
+		catch(...)
+		{
+			// Producers stop waiting for room once the writer has given up
+			madtError = current_exception();
+			SetAndWake(mbAborted);
+		}
+	}
+
+	FfsERSystemAssuranceBoundedQueue<WriteRequest> madtQueue;
+	AmsInt miBatchSize;
+	AmsDBConnectionPtr mpadtConnection;
+	atomic<AmsBoolean> mbFinished;
+	atomic<AmsBoolean> mbAborted;
+	AmsBoolean mbCommitted;
+	exception_ptr madtError;
+	mutex madtMutex;
+	condition_variable madtNotEmpty;
+	condition_variable madtNotFull;
+	thread madtThread;
+};
+
+FfsERSystemAssuranceWriter* mpadtWriter = NULL;
+
+// Hash for the string keys of the reference cache (FNV-1a)
+struct FfsERSystemAssuranceStringHash
+{
+	size_t operator()(const AmsString& strValue) const
+	{
+		size_t iHash = 2166136261u;
+		const char* pcValue = strValue.data();
+
+		for(size_t i = 0; i < strValue.length(); i++)
+		{
+			iHash ^= (unsigned char)pcValue[i];
+			iHash *= 16777619u;
+		}
+
+		return iHash;
+	}
+};
+
+// Fund, agency and partition rows the cell builders resolve for every source row.  The cache is loaded once
+// before the lines are processed and only read afterwards, so the line workers share it without locking.
+// Lookups that miss are counted.  The Resolve methods then read the row on the calling worker's connection
+// and keep it, behind a lock, for the other workers.
+class FfsERSystemAssuranceReferenceCache
+{
+public:
+	struct FundEntry
+	{
+		AmsString strFundId;
+		AmsString strTreasurySymbolId;
+		AmsString strFactsFundGroup;
+	};
+
+	FfsERSystemAssuranceReferenceCache()
+		: miHits(0), miMisses(0)
+	{
+	}
+
+	// Funds are restricted to those beginning no later than the last fiscal year of the run
+	AmsVoid Load(const AmsString& strLastFiscalYear)
+	{
+		madtFunds.clear();
+		madtFundsById.clear();
+		madtAgencyIds.clear();
+		madtPartitionCodes.clear();
+		madtMissedFunds.clear();
+		madtMissedFundsById.clear();
+		madtMissedAgencyIds.clear();
+		madtMissedPartitionCodes.clear();
+		miHits.store(0);
+		miMisses.store(0);
+
+		AmsDBSelector adtFundSelector;
+		FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr)GetPOFactory(FfsFund).GetStorage();
+		AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
+
+		adtFundSelector << adtFundTable["UIDY"] << adtFundTable["CD"] << adtFundTable["BBFY"] << adtFundTable["EBFY"]
+			<< adtFundTable["TSYM_ID"] << adtFundTable["FACTS_FUND_GRP"];
+
+		if(!strLastFiscalYear.isNull())
+			adtFundSelector.where(adtFundSelector.where() && (adtFundTable["BBFY"].isNull() || adtFundTable["BBFY"] <= strLastFiscalYear));
+
+		AmsGenericReaderPtr padtReader = new AmsGenericReader(adtFundSelector, mpadtWorkerConnection);
+
+		while(padtReader->NextRow())
+		{
+			FundEntry adtFund;
+			AmsString strCode;
+			AmsString strBBFY;
+			AmsString strEBFY;
+
+			(*padtReader) >> adtFund.strFundId >> strCode >> strBBFY >> strEBFY >> adtFund.strTreasurySymbolId >> adtFund.strFactsFundGroup;
+
+			FundEntry& adtEntry = madtFunds[GetFundKey(strCode, strBBFY, strEBFY)];
+			adtEntry = adtFund;
+			madtFundsById[adtFund.strFundId] = &adtEntry;
+		}
+
+		delete padtReader;
+
+		LoadCodes(GetPOFactory(FfsAgency), "CD", "UIDY", madtAgencyIds);
+		LoadCodes(GetPOFactory(FfsPartition), "UIDY", "CD", madtPartitionCodes);
+	}
+
+	// Fund by code and budget fiscal years
+	const FundEntry* FindFund(const AmsString& strCode, const AmsString& strBBFY, const AmsString& strEBFY)
+	{
+		unordered_map<AmsString, FundEntry, FfsERSystemAssuranceStringHash>::const_iterator it = madtFunds.find(GetFundKey(strCode, strBBFY, strEBFY));
+
+		return Count(it != madtFunds.end()) ? &((*it).second) : NULL;
+	}
+
+	const FundEntry* FindFundById(const AmsString& strFundId)
+	{
+		unordered_map<AmsString, const FundEntry*, FfsERSystemAssuranceStringHash>::const_iterator it = madtFundsById.find(strFundId);
+
+		return Count(it != madtFundsById.end()) ? (*it).second : NULL;
+	}
+
+	AmsBoolean FindAgencyId(const AmsString& strAgencyCode, AmsString& strAgencyId)
+	{
+		return Find(madtAgencyIds, strAgencyCode, strAgencyId);
+	}
+
+	AmsBoolean FindPartitionCode(const AmsString& strPartitionId, AmsString& strPartitionCode)
+	{
+		return Find(madtPartitionCodes, strPartitionId, strPartitionCode);
+	}
+
+	// The Resolve methods fall back to a query on the caller's connection for keys the preload does not have,
+	// and remember the answer, found or not, for the rest of the run.  A null key is never looked up.
+	AmsBoolean ResolveFund(const AmsString& strCode, const AmsString& strBBFY, const AmsString& strEBFY, FundEntry& adtFund)
+	{
+		if(strCode.isNull())
+			return FALSE;
+
+		const FundEntry* padtFund = FindFund(strCode, strBBFY, strEBFY);
+
+		if(padtFund)
+		{
+			adtFund = *padtFund;
+			return TRUE;
+		}
+
+		FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr)GetPOFactory(FfsFund).GetStorage();
+		AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
+
+		return ResolveFundWhere(GetFundKey(strCode, strBBFY, strEBFY), madtMissedFunds, adtFundTable["CD"] == strCode &&
+			MatchesValue(adtFundTable["BBFY"], strBBFY) && MatchesValue(adtFundTable["EBFY"], strEBFY), adtFund);
+	}
+
+	AmsBoolean ResolveFundById(const AmsString& strFundId, FundEntry& adtFund)
+	{
+		if(strFundId.isNull())
+			return FALSE;
+
+		const FundEntry* padtFund = FindFundById(strFundId);
+
+		if(padtFund)
+		{
+			adtFund = *padtFund;
+			return TRUE;
+		}
+
+		FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr)GetPOFactory(FfsFund).GetStorage();
+		AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
+
+		return ResolveFundWhere(strFundId, madtMissedFundsById, adtFundTable["UIDY"] == strFundId, adtFund);
+	}
+
+	AmsBoolean ResolveAgencyId(const AmsString& strAgencyCode, AmsString& strAgencyId)
+	{
+		if(strAgencyCode.isNull())
+			return FALSE;
+
+		if(FindAgencyId(strAgencyCode, strAgencyId))
+			return TRUE;
+
+		return ResolveCode(GetPOFactory(FfsAgency), "CD", "UIDY", madtMissedAgencyIds, strAgencyCode, strAgencyId);
+	}
+
+	AmsBoolean ResolvePartitionCode(const AmsString& strPartitionId, AmsString& strPartitionCode)
+	{
+		if(strPartitionId.isNull())
+			return FALSE;
+
+		if(FindPartitionCode(strPartitionId, strPartitionCode))
+			return TRUE;
+
+		return ResolveCode(GetPOFactory(FfsPartition), "UIDY", "CD", madtMissedPartitionCodes, strPartitionId, strPartitionCode);
+	}
+
+	long GetHits() const
+	{
+		return miHits.load();
+	}
+
+	long GetMisses() const
+	{
+		return miMisses.load();
+	}
+
+private:
+	static AmsString GetFundKey(const AmsString& strCode, const AmsString& strBBFY, const AmsString& strEBFY)
+	{
+		return strCode + "|" + strBBFY + "|" + strEBFY;
+	}
+
+	AmsVoid LoadCodes(AmsBaseFactory& adtFactory, const AmsString& strKeyColumn, const AmsString& strValueColumn,
+		unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash>& adtCodes)
+	{
+		AmsDBSelector adtSelector;
+		AmsDBTable adtTable = adtFactory.GetStorage()->GetTables()->front()->GetTable();
+
+		adtSelector << adtTable[strKeyColumn] << adtTable[strValueColumn];
+
+		AmsGenericReaderPtr padtReader = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+		AmsString strKey;
+		AmsString strValue;
+
+		while(padtReader->NextRow())
+		{
+			(*padtReader) >> strKey >> strValue;
+			adtCodes[strKey] = strValue;
+		}
+
+		delete padtReader;
+	}
+
+	static AmsDBCriterion MatchesValue(const AmsDBColumn& adtColumn, const AmsString& strValue)
+	{
+		return (strValue.isNull() ? adtColumn.isNull() : adtColumn == strValue);
+	}
+
+	AmsBoolean ResolveFundWhere(const AmsString& strKey, unordered_map<AmsString, FundEntry, FfsERSystemAssuranceStringHash>& adtMissed,
+		const AmsDBCriterion& adtCriterion, FundEntry& adtFund)
+	{
+		{
+			shared_lock<shared_mutex> adtReadLock(madtMissedMutex);
+			unordered_map<AmsString, FundEntry, FfsERSystemAssuranceStringHash>::const_iterator it = adtMissed.find(strKey);
+
+			// A fund the query did not find is kept with a null id
+			if(it != adtMissed.end())
+			{
+				adtFund = (*it).second;
+				return !adtFund.strFundId.isNull();
+			}
+		}
+
+		AmsDBSelector adtSelector;
+		FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr)GetPOFactory(FfsFund).GetStorage();
+		AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
+
+		adtSelector << adtFundTable["UIDY"] << adtFundTable["TSYM_ID"] << adtFundTable["FACTS_FUND_GRP"];
+		adtSelector.where(adtCriterion);
+
+		AmsGenericReaderPtr padtReader = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+		AmsBoolean bFound = padtReader->NextRow();
+
+		if(bFound)
+			(*padtReader) >> adtFund.strFundId >> adtFund.strTreasurySymbolId >> adtFund.strFactsFundGroup;
+		else
+			adtFund = FundEntry();
+
+		delete padtReader;
+
+		unique_lock<shared_mutex> adtWriteLock(madtMissedMutex);
+		adtMissed[strKey] = adtFund;
+
+		return !adtFund.strFundId.isNull();
+	}
+
+	AmsBoolean ResolveCode(AmsBaseFactory& adtFactory, const AmsString& strKeyColumn, const AmsString& strValueColumn,
+		unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash>& adtMissed, const AmsString& strKey, AmsString& strValue)
+	{
+		{
+			shared_lock<shared_mutex> adtReadLock(madtMissedMutex);
+			unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash>::const_iterator it = adtMissed.find(strKey);
+
+			// A key the query did not find is kept with a null value
+			if(it != adtMissed.end())
+			{
+				strValue = (*it).second;
+				return !strValue.isNull();
+			}
+		}
+
+		AmsDBSelector adtSelector;
+		AmsDBTable adtTable = adtFactory.GetStorage()->GetTables()->front()->GetTable();
+
+		adtSelector << adtTable[strValueColumn];
+		adtSelector.where(adtTable[strKeyColumn] == strKey);
+
+		AmsGenericReaderPtr padtReader = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+		AmsBoolean bFound = padtReader->NextRow();
+
+		if(bFound)
+			(*padtReader) >> strValue;
+		else
+			strValue = AmsString();
+
+		delete padtReader;
+
+		unique_lock<shared_mutex> adtWriteLock(madtMissedMutex);
+		adtMissed[strKey] = strValue;
+
+		return !strValue.isNull();
+	}
+
+	AmsBoolean Find(const unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash>& adtCodes, const AmsString& strKey, AmsString& strValue)
+	{
+		unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash>::const_iterator it = adtCodes.find(strKey);
+
+		if(!Count(it != adtCodes.end()))
+			return FALSE;
+
+		strValue = (*it).second;
+		return TRUE;
+	}
+
+	AmsBoolean Count(AmsBoolean bFound)
+	{
+		if(bFound)
+			miHits.fetch_add(1, memory_order_relaxed);
+		else
+			miMisses.fetch_add(1, memory_order_relaxed);
+
+		return bFound;
+	}
+
+	unordered_map<AmsString, FundEntry, FfsERSystemAssuranceStringHash> madtFunds;
+	unordered_map<AmsString, const FundEntry*, FfsERSystemAssuranceStringHash> madtFundsById;
+	unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash> madtAgencyIds;
+	unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash> madtPartitionCodes;
+	unordered_map<AmsString, FundEntry, FfsERSystemAssuranceStringHash> madtMissedFunds;
+	unordered_map<AmsString, FundEntry, FfsERSystemAssuranceStringHash> madtMissedFundsById;
+	unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash> madtMissedAgencyIds;
+	unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash> madtMissedPartitionCodes;
+	shared_mutex madtMissedMutex;
+	atomic<long> miHits;
+	atomic<long> miMisses;
+};
+
+FfsERSystemAssuranceReferenceCache madtReferenceCache;
+
+// GL accounts of one fiscal year, loaded with a single query.  Besides code to id, the accounts are indexed by
+// each of the columns GetGLAccountCriteria selects them by, so rollup usages resolve to literal value lists
+// instead of sub-selects against the GL account table.  An index is never changed once it is loaded, and the
+// indexes are dropped at the start of every run so a run sees the accounts as they are when it starts.
+class FfsERSystemAssuranceGLAccountIndex
+{
+public:
+	AmsVoid Load(const AmsString& strFiscalYear)
+	{
+		static const char* apcByColumns[] = { "UIDY", "STND_GL_ACCT_ID", "SUMR_GLAC_ID", "ACTG_CAT_ID", "ACTG_CLAS_ID", "ACTG_GRP_ID", "ACTG_TYP_ID" };
+		const AmsInt iByColumnCount = sizeof(apcByColumns) / sizeof(apcByColumns[0]);
+
+		AmsDBSelector adtSelector;
+		FfsGLAccountSQLPtr padtGLSQL = (FfsGLAccountSQLPtr)GetPOFactory(FfsGLAccount).GetStorage();
+		AmsDBTable adtGLTable = padtGLSQL->GetTables()->front()->GetTable();
+
+		adtSelector << adtGLTable["CD"];
+
+		for(AmsInt i = 0; i < iByColumnCount; i++)
+			adtSelector << adtGLTable[apcByColumns[i]];
+
+		adtSelector.where(adtGLTable["FISC_YEAR"] == strFiscalYear);
+
+		AmsGenericReaderPtr padtReader = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+
+		while(padtReader->NextRow())
+		{
+			Account adtAccount;
+			(*padtReader) >> adtAccount.strCode;
+
+			for(AmsInt i = 0; i < iByColumnCount; i++)
+			{
+				AmsString strValue;
+				(*padtReader) >> strValue;
+
+				if(i == 0)
+					adtAccount.strId = strValue;
+				else if(i == 1)
+					adtAccount.strStandardId = strValue;
+
+				if(!strValue.isNull())
+					madtAccountsByColumn[apcByColumns[i]][strValue].push_back(madtAccounts.size());
+			}
+
+			madtIdsByCode[adtAccount.strCode] = adtAccount.strId;
+			madtAccounts.push_back(adtAccount);
+		}
+
+		delete padtReader;
+	}
+
+	AmsBoolean FindId(const AmsString& strCode, AmsString& strId) const
+	{
+		unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash>::const_iterator it = madtIdsByCode.find(strCode);
+
+		if(it == madtIdsByCode.end())
+			return FALSE;
+
+		strId = (*it).second;
+		return TRUE;
+	}
+
+	// Distinct values of strSelectedColumn (UIDY, CD or STND_GL_ACCT_ID) of the accounts whose strByColumn is strValue.
+	// Returns FALSE when the index cannot answer, in which case the caller falls back to a sub-select.
+	AmsBoolean GetValues(const AmsString& strSelectedColumn, const AmsString& strByColumn, const AmsString& strValue,
+		deque<AmsString>& adtValues) const
+	{
+		map<AmsString, unordered_map<AmsString, deque<AmsInt>, FfsERSystemAssuranceStringHash>, less<AmsString>>::const_iterator itColumn =
+			madtAccountsByColumn.find(strByColumn);
+
+		if(itColumn == madtAccountsByColumn.end())
+			return FALSE;
+
+		unordered_map<AmsString, deque<AmsInt>, FfsERSystemAssuranceStringHash>::const_iterator itValue = (*itColumn).second.find(strValue);
+
+		if(itValue == (*itColumn).second.end())
+			return FALSE;
+
+		set<AmsString, less<AmsString>> adtDistinctValues;
+		const deque<AmsInt>& adtPositions = (*itValue).second;
+
+		for(AmsInt i = 0; i < adtPositions.size(); i++)
+		{
+			const Account& adtAccount = madtAccounts[adtPositions[i]];
+
+			if(strSelectedColumn == "UIDY")
+				adtDistinctValues.insert(adtAccount.strId);
+			else if(strSelectedColumn == "CD")
+				adtDistinctValues.insert(adtAccount.strCode);
+			else if(strSelectedColumn == "STND_GL_ACCT_ID")
+				adtDistinctValues.insert(adtAccount.strStandardId);
+			else
+				return FALSE;
+		}
+
+		adtValues.insert(adtValues.end(), adtDistinctValues.begin(), adtDistinctValues.end());
+		return adtValues.size() > 0;
+	}
+
+private:
+	struct Account
+	{
+		AmsString strId;
+		AmsString strCode;
+		AmsString strStandardId;
+	};
+
+	deque<Account> madtAccounts;
+	unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash> madtIdsByCode;
+	map<AmsString, unordered_map<AmsString, deque<AmsInt>, FfsERSystemAssuranceStringHash>, less<AmsString>> madtAccountsByColumn;
+};
+
+map<AmsString, unique_ptr<FfsERSystemAssuranceGLAccountIndex>> madtGLAccountIndexMap;
+mutex madtGLAccountIndexMutex;
+
+// Accounting periods of one fiscal year, loaded with a single query so the period criteria can be sent
+// as literal month lists.  A calendar is never changed once it is loaded; like the GL account indexes, the
+// calendars are dropped at the start of every run.
+class FfsERSystemAssuranceFiscalCalendar
+{
+public:
+	AmsVoid Load(const AmsString& strFiscalYear)
+	{
+		AmsDBSelector adtSelector;
+		FfsAccountingPeriodSQLPtr padtAccountingPeriodSQL = (FfsAccountingPeriodSQLPtr)GetPOFactory(FfsAccountingPeriod).GetStorage();
+		AmsDBTable adtAccountingPeriodTable = padtAccountingPeriodSQL->GetTables()->front()->GetTable();
+
+		adtSelector << adtAccountingPeriodTable["FISC_MNTH"] << adtAccountingPeriodTable["CLSG_PERD_FL"]
+			<< adtAccountingPeriodTable["BEGN_PERD_FL"] << adtAccountingPeriodTable["FISC_QUAR"];
+		adtSelector.where(adtAccountingPeriodTable["FISC_YEAR"] == strFiscalYear);
+
+		AmsGenericReaderPtr padtReader = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+		AmsString strFiscalMonth;
+		AmsString strClosingPeriodFlag;
+		AmsString strBeginningPeriodFlag;
+		AmsString strFiscalQuarter;
+
+		while(padtReader->NextRow())
+		{
+			(*padtReader) >> strFiscalMonth >> strClosingPeriodFlag >> strBeginningPeriodFlag >> strFiscalQuarter;
+
+			if(strClosingPeriodFlag == "T")
+				madtClosingMonths.push_back(strFiscalMonth);
+
+			if(strBeginningPeriodFlag == "T")
+				madtBeginningMonths.push_back(strFiscalMonth);
+
+			madtMonthsByQuarter[strFiscalQuarter].push_back(strFiscalMonth);
+		}
+
+		delete padtReader;
+	}
+
+	const deque<AmsString>& GetClosingMonths() const
+	{
+		return madtClosingMonths;
+	}
+
+	const deque<AmsString>& GetBeginningMonths() const
+	{
+		return madtBeginningMonths;
+	}
+
+	const deque<AmsString>& GetMonthsByQuarter(const AmsString& strFiscalQuarter) const
+	{
+		map<AmsString, deque<AmsString>, less<AmsString>>::const_iterator it = madtMonthsByQuarter.find(strFiscalQuarter);
+
+		return (it != madtMonthsByQuarter.end() ? (*it).second : madtNoMonths);
+	}
+
+private:
+	deque<AmsString> madtClosingMonths;
+	deque<AmsString> madtBeginningMonths;
+	map<AmsString, deque<AmsString>, less<AmsString>> madtMonthsByQuarter;
+	deque<AmsString> madtNoMonths;
+};
+
+map<AmsString, unique_ptr<FfsERSystemAssuranceFiscalCalendar>> madtFiscalCalendarMap;
+mutex madtFiscalCalendarMutex;
+
+// FACTS I and FACTS II attribute definitions, shared by every run in the process.  The first lookup for a
+// fiscal year loads all of that year's definitions in one query into a flat flag column table kept per
+// (family, fiscal year).  Lookups take a shared lock, so concurrent readers do not wait for each other.
+class FfsERSystemAssuranceFactsAttributeCache
+{
+public:
+	static const AmsString FACTS1;
+	static const AmsString FACTS2;
+
+	// Attribute number whose flag column is set, or a null string when no attribute of the year has it
+	AmsString GetAttributeNumber(AmsBaseFactory& adtFactory, const AmsString& strFamily, const AmsString& strFiscalYear,
+		const AmsString& strFlagColumn)
+	{
+		YearKey adtYearKey(strFamily, strFiscalYear);
+
+		{
+			shared_lock<shared_mutex> adtReadLock(madtMutex);
+			map<YearKey, Year>::const_iterator it = madtYears.find(adtYearKey);
+
+			if(it != madtYears.end() && (*it).second.bLoaded)
+			{
+				unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash>::const_iterator itNumber =
+					(*it).second.adtAttributeNumbers.find(strFlagColumn);
+
+				if(itNumber != (*it).second.adtAttributeNumbers.end())
+					return (*itNumber).second;
+			}
+		}
+
+		unique_lock<shared_mutex> adtWriteLock(madtMutex);
+		Year& adtYear = madtYears[adtYearKey];
+
+		// Another reader may have loaded the year while the lock was released
+		if(!adtYear.bLoaded)
+		{
+			FfsERSystemAssuranceTraceSpan adtSpan("loadFactsAttributes");
+			Load(adtFactory, strFamily, strFiscalYear, adtYear);
+			adtYear.bLoaded = TRUE;
+		}
+
+		// A flag column outside the preloaded ones is looked up on its own and kept like the others
+		if(!adtYear.adtAttributeNumbers.count(strFlagColumn))
+			LoadColumn(adtFactory, strFiscalYear, strFlagColumn, adtYear);
+
+		return adtYear.adtAttributeNumbers[strFlagColumn];
+	}
+
+	// Whether a flag column is set on one attribute of the year
+	AmsBoolean IsAttributeFlagSet(AmsBaseFactory& adtFactory, const AmsString& strFamily, const AmsString& strFiscalYear,
+		const AmsString& strAttributeNumber, const AmsString& strFlagColumn)
+	{
+		YearKey adtYearKey(strFamily, strFiscalYear);
+		FlagKey adtFlagKey(strAttributeNumber, strFlagColumn);
+
+		{
+			shared_lock<shared_mutex> adtReadLock(madtMutex);
+			map<YearKey, Year>::const_iterator it = madtYears.find(adtYearKey);
+
+			if(it != madtYears.end())
+			{
+				map<FlagKey, AmsBoolean>::const_iterator itFlag = (*it).second.adtAttributeFlags.find(adtFlagKey);
+
+				if(itFlag != (*it).second.adtAttributeFlags.end())
+					return (*itFlag).second;
+			}
+		}
+
+		unique_lock<shared_mutex> adtWriteLock(madtMutex);
+		Year& adtYear = madtYears[adtYearKey];
+
+		if(!adtYear.adtAttributeFlags.count(adtFlagKey))
+			LoadFlag(adtFactory, strFiscalYear, strAttributeNumber, strFlagColumn, adtYear);
+
+		return adtYear.adtAttributeFlags[adtFlagKey];
+	}
+
+	// Drops the definitions of one fiscal year of both families, or of every year when none is given
+	AmsVoid Invalidate(const AmsString& strFiscalYear)
+	{
+		unique_lock<shared_mutex> adtWriteLock(madtMutex);
+
+		if(strFiscalYear.isNull())
+		{
+			madtYears.clear();
+			return;
+		}
+
+		madtYears.erase(YearKey(FACTS1, strFiscalYear));
+		madtYears.erase(YearKey(FACTS2, strFiscalYear));
+	}
+
+private:
+	// (family, fiscal year) and (attribute number, flag column)
+	typedef pair<AmsString, AmsString> YearKey;
+	typedef pair<AmsString, AmsString> FlagKey;
+
+	struct Year
+	{
+		Year() : bLoaded(FALSE)
+		{
+		}
+
+		AmsBoolean bLoaded;
+		unordered_map<AmsString, AmsString, FfsERSystemAssuranceStringHash> adtAttributeNumbers;
+		map<FlagKey, AmsBoolean> adtAttributeFlags;
+	};
+
+	// Called with the write lock held.  Every flag column of the family gets an entry, empty when no attribute has it.
+	AmsVoid Load(AmsBaseFactory& adtFactory, const AmsString& strFamily, const AmsString& strFiscalYear, Year& adtYear)
+	{
+		static const char* apcFacts1FlagColumns[] = { "TRDG_PTNR_FL", "TRDG_PTNR_AGCY_FL" };
+		static const char* apcFacts2FlagColumns[] = { "TRAN_PTNR_FL", "TRFR_AGCY_ACCT_FL" };
+
+		const char** ppcFlagColumns = (strFamily == FACTS1 ? apcFacts1FlagColumns : apcFacts2FlagColumns);
+		const AmsInt iFlagColumnCount = (strFamily == FACTS1 ? sizeof(apcFacts1FlagColumns) : sizeof(apcFacts2FlagColumns)) / sizeof(const char*);
+
+		AmsDBSelector adtSelector;
+		AmsTableMapPtr padtTable = adtFactory.GetStorage()->GetTables()->front();
+
+		adtSelector << padtTable->GetTable()["ATTR_NUM"];
+
+		for(AmsInt i = 0; i < iFlagColumnCount; i++)
+		{
+			adtSelector << padtTable->GetTable()[ppcFlagColumns[i]];
+			adtYear.adtAttributeNumbers[ppcFlagColumns[i]] = AmsString();
+		}
+
+		adtSelector.where(padtTable->GetTable()["FISC_YEAR"] == strFiscalYear);
+
+		AmsGenericReaderPtr padtReader = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+
+		while(padtReader->NextRow())
+		{
+			AmsString strAttributeNumber;
+			(*padtReader) >> strAttributeNumber;
+
+			// Remove leading zero if necessary
+			strAttributeNumber = (strAttributeNumber(0,1) == "0" ? strAttributeNumber(1) : strAttributeNumber);
+
+			for(AmsInt i = 0; i < iFlagColumnCount; i++)
+			{
+				AmsString strFlag;
+				(*padtReader) >> strFlag;
+
+				// The first attribute of the year with the flag wins
+				AmsString& strNumber = adtYear.adtAttributeNumbers[ppcFlagColumns[i]];
+
+				if(strFlag == "T" && strNumber.isNull())
+					strNumber = strAttributeNumber;
+			}
+		}
+
+		delete padtReader;
+	}
+
+	// Called with the write lock held.  Attribute numbers may be stored with a leading zero.
+	AmsVoid LoadFlag(AmsBaseFactory& adtFactory, const AmsString& strFiscalYear, const AmsString& strAttributeNumber,
+		const AmsString& strFlagColumn, Year& adtYear)
+	{
+		AmsDBSelector adtSelector;
+		AmsTableMapPtr padtTable = adtFactory.GetStorage()->GetTables()->front();
+
+		adtSelector << padtTable->GetTable()[strFlagColumn];
+		adtSelector.where(padtTable->GetTable()["FISC_YEAR"] == strFiscalYear && (padtTable->GetTable()["ATTR_NUM"] == strAttributeNumber ||
+			padtTable->GetTable()["ATTR_NUM"] == "0" + strAttributeNumber));
+
+		AmsGenericReaderPtr padtReader = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+		AmsString strFlag;
+
+		if(padtReader->NextRow())
+			(*padtReader) >> strFlag;
+
+		delete padtReader;
+
+		adtYear.adtAttributeFlags[FlagKey(strAttributeNumber, strFlagColumn)] = (strFlag == "T");
+	}
+
+	// Called with the write lock held
+	AmsVoid LoadColumn(AmsBaseFactory& adtFactory, const AmsString& strFiscalYear, const AmsString& strFlagColumn, Year& adtYear)
+	{
+		AmsDBSelector adtSelector;
+		AmsTableMapPtr padtTable = adtFactory.GetStorage()->GetTables()->front();
+
+		adtSelector << padtTable->GetTable()["ATTR_NUM"];
+		adtSelector.where(padtTable->GetTable()["FISC_YEAR"] == strFiscalYear && padtTable->GetTable()[strFlagColumn] == "T");
+
+		AmsGenericReaderPtr padtReader = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+		AmsString strAttributeNumber;
+
+		if(padtReader->NextRow())
+			(*padtReader) >> strAttributeNumber;
+
+		delete padtReader;
+
+		// Remove leading zero if necessary
+		adtYear.adtAttributeNumbers[strFlagColumn] = (strAttributeNumber(0,1) == "0" ? strAttributeNumber(1) : strAttributeNumber);
+	}
+
+	shared_mutex madtMutex;
+	map<YearKey, Year> madtYears;
+};
+
+const AmsString FfsERSystemAssuranceFactsAttributeCache::FACTS1 = "FACTS1";
+const AmsString FfsERSystemAssuranceFactsAttributeCache::FACTS2 = "FACTS2";
+
+FfsERSystemAssuranceFactsAttributeCache madtFactsAttributeCache;
+
+// FACTS attribute value accessors, indexed by attribute number - 1
+typedef decltype(&FfsFactsAbstractReportDetail::GetAttribute1Value) FfsERSystemAssuranceFactsAttributeAccessor;
+
+const FfsERSystemAssuranceFactsAttributeAccessor madtFactsAttributeAccessors[] =
+{
+	&FfsFactsAbstractReportDetail::GetAttribute1Value, &FfsFactsAbstractReportDetail::GetAttribute2Value, &FfsFactsAbstractReportDetail::GetAttribute3Value, &FfsFactsAbstractReportDetail::GetAttribute4Value, &FfsFactsAbstractReportDetail::GetAttribute5Value,
+	&FfsFactsAbstractReportDetail::GetAttribute6Value, &FfsFactsAbstractReportDetail::GetAttribute7Value, &FfsFactsAbstractReportDetail::GetAttribute8Value, &FfsFactsAbstractReportDetail::GetAttribute9Value, &FfsFactsAbstractReportDetail::GetAttribute10Value,
+	&FfsFactsAbstractReportDetail::GetAttribute11Value, &FfsFactsAbstractReportDetail::GetAttribute12Value, &FfsFactsAbstractReportDetail::GetAttribute13Value, &FfsFactsAbstractReportDetail::GetAttribute14Value, &FfsFactsAbstractReportDetail::GetAttribute15Value,
+	&FfsFactsAbstractReportDetail::GetAttribute16Value, &FfsFactsAbstractReportDetail::GetAttribute17Value, &FfsFactsAbstractReportDetail::GetAttribute18Value, &FfsFactsAbstractReportDetail::GetAttribute19Value, &FfsFactsAbstractReportDetail::GetAttribute20Value,
+	&FfsFactsAbstractReportDetail::GetAttribute21Value, &FfsFactsAbstractReportDetail::GetAttribute22Value, &FfsFactsAbstractReportDetail::GetAttribute23Value, &FfsFactsAbstractReportDetail::GetAttribute24Value, &FfsFactsAbstractReportDetail::GetAttribute25Value
+};
+
+const AmsInt FACTS_ATTRIBUTE_COUNT = sizeof(madtFactsAttributeAccessors) / sizeof(madtFactsAttributeAccessors[0]);
+
+// Aspect of a source object the projected row decode reads, with the column it is read from.  The partial
+// select lists the aspects in this order and ReadProjectedRow streams them back in the same order.
+struct FfsERSystemAssuranceProjectedColumn
+{
+	const char* pcAspect;
+	const char* pcColumn;
+};
+
+const FfsERSystemAssuranceProjectedColumn madtAbstractExternalReportProjection[] =
+{
+	{ "identity", "UIDY" },
+	{ "fund", "FUND" },
+	{ "beginningBudgetFiscalYear", "BBFY" },
+	{ "endingBudgetFiscalYear", "EBFY" },
+	{ "originalAmount", "ORIG_AMT" },
+	{ "totalAmount", "TOT_AMT" }
+};
+
+const FfsERSystemAssuranceProjectedColumn madtFactsAbstractReportProjection[] =
+{
+	{ "identity", "UIDY" },
+	{ "partition", "PATN" },
+	{ "factsFundGroup", "FACTS_FUND_GRP" },
+	{ "fundId", "FUND_ID" },
+	{ "treasurySymbolId", "TSYM_ID" },
+	{ "originalAmount", "ORIG_AMT" },
+	{ "reportedAmount", "RPTD_AMT" }
+};
+
+const FfsERSystemAssuranceProjectedColumn madtGLRollupProjection[] =
+{
+	{ "identity", "UIDY" },
+	{ "partition", "PATN" },
+	{ "fund", "FUND" },
+	{ "beginningBudgetFiscalYear", "BBFY" },
+	{ "endingBudgetFiscalYear", "EBFY" },
+	{ "treasurySymbolId", "TSYM_ID" },
+	{ "tradingPartner", "TRDG_PTNR" },
+	{ "debitBalance", "DR_BAL" },
+	{ "creditBalance", "CR_BAL" }
+};
+
+// Source row as the projected decode reads it: only the fields the cell detail is built from.  The values are
+// kept as AmsStrings, as the cell detail setters take them, so this is a flat row rather than a POD.
+struct FfsERSystemAssuranceProjectedRow
+{
+	AmsString strLinkId;
+	AmsString strPartition;
+	AmsString strFund;
+	AmsString strBBFY;
+	AmsString strEBFY;
+	AmsString strFundId;
+	AmsString strTreasurySymbolId;
+	AmsString strTradingPartner;
+	AmsString strFactsFundGroup;
+	double dAmount;
+};
+
+// Partial query info per detail factory selecting only the projected aspects.  The GL factory of a group
+// changes per cell, so the info is built the first time a factory is read and shared by the line workers.
+class FfsERSystemAssuranceRowProjections
+{
+public:
+	~FfsERSystemAssuranceRowProjections()
+	{
+		Clear();
+	}
+
+	AmsPartialQueryInfoPtr Get(AmsBaseFactory& adtFactory, const FfsERSystemAssuranceProjectedColumn* padtColumns, AmsInt iColumnCount)
+	{
+		lock_guard<mutex> adtLock(madtProjectionsMutex);
+
+		map<AmsBaseFactory*, AmsPartialQueryInfoPtr>::iterator it = madtProjections.find(&adtFactory);
+
+		if(it != madtProjections.end())
+			return (*it).second;
+
+		AmsPartialQueryInfoPtr padtPartialQueryInfo = new AmsPartialQueryInfo;
+
+		for(AmsInt i = 0; i < iColumnCount; i++)
+		{
+			AmsInt iAspect = adtFactory.GetStorage()->GetColumnIndexForPartialSelect(padtColumns[i].pcAspect);
+			padtPartialQueryInfo->SetQueryAspect(iAspect, AmsSQLHelper::NONE);
+		}
+
+		madtProjections[&adtFactory] = padtPartialQueryInfo;
+		return padtPartialQueryInfo;
+	}
+
+	AmsVoid Clear()
+	{
+		lock_guard<mutex> adtLock(madtProjectionsMutex);
+
+		map<AmsBaseFactory*, AmsPartialQueryInfoPtr>::iterator it = madtProjections.begin();
+
+		for( ; it != madtProjections.end(); it++)
+			delete (*it).second;
+
+		madtProjections.clear();
+	}
+
+private:
+	mutex madtProjectionsMutex;
+	map<AmsBaseFactory*, AmsPartialQueryInfoPtr> madtProjections;
+};
+
+FfsERSystemAssuranceRowProjections madtRowProjections;
+
+// Dense line x column table of the definition columns and cells the report columns read.  It is built once
+// before the lines are processed, with every child relation the criteria builders walk resolved up front, so
+// the line workers only read it and never trigger a lazy load of a definition object they share.
+class FfsERSystemAssuranceDefinitionIndex
+{
+public:
+	FfsERSystemAssuranceDefinitionIndex()
+		: miLineCount(0)
+	{
+	}
+
+	AmsVoid Build(FfsERSystemAssuranceDefinitionPtr padtDefinition,
+				  map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>& adtColumnParameters)
+	{
+		madtColumnSlots.clear();
+		madtColumns.clear();
+		madtCells.clear();
+
+		map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>::iterator it = adtColumnParameters.begin();
+
+		for( ; it != adtColumnParameters.end(); it++)
+		{
+			FfsERSystemAssuranceDefinitionColumnPtr padtColumn = padtDefinition->GetColumn(AmsULongToStr((*it).first));
+
+			if(padtColumn)
+			{
+				Resolve(padtColumn->GetTreasurySymbols());
+				Resolve(padtColumn->GetPartitions());
+				Resolve(padtColumn->GetBureaus());
+				Resolve(padtColumn->GetAccountingDimensions());
+				Resolve(padtColumn->GetColumnDimensionStrip());
+			}
+
+			madtColumnSlots[(*it).first] = madtColumns.size();
+			madtColumns.push_back(padtColumn);
+		}
+
+		miLineCount = padtDefinition->LineCount();
+		madtCells.assign(miLineCount * madtColumns.size(), NULL);
+
+		for(AmsInt i = 0; i < miLineCount; i++)
+		{
+			FfsERSystemAssuranceDefinitionLinePtr padtLine = (FfsERSystemAssuranceDefinitionLinePtr) padtDefinition->GetLine(i);
+
+			if(padtLine->GetAmountsLiteralIndicator().GetValue() != FfsExternalReportAbstractDefinitionLine::AMOUNT)
+				continue;
+
+			ResolveGLAccounts(padtLine->GetGLAccounts());
+			Resolve(padtLine->GetTradingPartners());
+
+			map<AmsInt, size_t>::iterator itSlot = madtColumnSlots.begin();
+
+			for( ; itSlot != madtColumnSlots.end(); itSlot++)
+			{
+				FfsERSystemAssuranceDefinitionCellPtr padtCell = padtDefinition->GetCell(padtLine->GetSectionNumber().GetValue(),
+					padtLine->GetLineNumber().GetValue(), AmsULongToStr((*itSlot).first));
+
+				if(!padtCell)
+					continue;
+
+				ResolveGLAccounts(padtCell->GetGLAccounts());
+				Resolve(padtCell->GetTreasurySymbols());
+				Resolve(padtCell->GetPartitions());
+				Resolve(padtCell->GetBureaus());
+				Resolve(padtCell->GetAccountingDimensions());
+				Resolve(padtCell->GetTradingPartners());
+				Resolve(padtCell->GetDimensionStrip());
+				Resolve(padtCell->GetFormAndContentReportDefinitions());
+				Resolve(padtCell->GetExternalReportDefinitions());
+
+				madtCells[i * madtColumns.size() + (*itSlot).second] = padtCell;
+			}
+		}
+	}
+
+	FfsERSystemAssuranceDefinitionColumnPtr GetColumn(AmsInt iColumn) const
+	{
+		map<AmsInt, size_t>::const_iterator it = madtColumnSlots.find(iColumn);
+		return (it != madtColumnSlots.end() ? madtColumns[(*it).second] : NULL);
+	}
+
+	// Cell of an AMOUNT line by line sequence and column number
+	FfsERSystemAssuranceDefinitionCellPtr GetCell(AmsInt iLineSequence, AmsInt iColumn) const
+	{
+		map<AmsInt, size_t>::const_iterator it = madtColumnSlots.find(iColumn);
+
+		if(it == madtColumnSlots.end() || iLineSequence < 0 || iLineSequence >= miLineCount)
+			return NULL;
+
+		return madtCells[iLineSequence * madtColumns.size() + (*it).second];
+	}
+
+private:
+	static AmsVoid Resolve(AmsManyRelationPtr padtRelation)
+	{
+		if(padtRelation)
+			padtRelation->Size();
+	}
+
+	// The GL account criteria also walk the FACTS attributes of every account
+	static AmsVoid ResolveGLAccounts(AmsManyRelationPtr padtGLAccounts)
+	{
+		if(!padtGLAccounts)
+			return;
+
+		for(AmsInt i = 0; i < padtGLAccounts->Size(); i++)
+		{
+			FfsERSystemAssuranceDefinitionCellGLAccountPtr padtGLAccount = (*padtGLAccounts)[i];
+
+			Resolve(padtGLAccount->GetFacts1Attributes());
+			Resolve(padtGLAccount->GetFacts2Attributes());
+		}
+	}
+
+	AmsInt miLineCount;
+	map<AmsInt, size_t> madtColumnSlots;
+	vector<FfsERSystemAssuranceDefinitionColumnPtr> madtColumns;
+	vector<FfsERSystemAssuranceDefinitionCellPtr> madtCells;
+};
+
+FfsERSystemAssuranceDefinitionIndex madtDefinitionIndex;
+
+// Line and column totals of the definition compiled into dependency order.  A total line is the signed sum of
+// its from-lines in every column and a total column the signed sum of its from-columns on every other line.
+// Amounts are kept as one lines x columns array of doubles, so totals of totals are evaluated once, in order,
+// from the amounts already computed, and report lines are only filled from the array when they are added.
+class FfsERSystemAssuranceTotalsGraph
+{
+public:
+	struct Term
+	{
+		size_t iFrom;
+		AmsInt iSign;
+	};
+
+	struct Total
+	{
+		size_t iTarget;
+		vector<Term> adtTerms;
+	};
+
+	FfsERSystemAssuranceTotalsGraph()
+		: miLineCount(0)
+	{
+	}
+
+	// Returns FALSE when the totals refer to each other in a cycle; strCycle then holds a line or column on it
+	AmsBoolean Build(FfsERSystemAssuranceDefinitionPtr padtDefinition, AmsString& strCycleLine, AmsString& strCycleColumn)
+	{
+		map<AmsString, size_t> adtLineSlots;
+		madtColumnSlots.clear();
+		madtColumnNumbers.clear();
+		madtLineTotals.clear();
+		madtColumnTotals.clear();
+
+		miLineCount = padtDefinition->LineCount();
+		madtLineNumbers.assign(miLineCount, AmsString());
+
+		for(AmsInt i = 0; i < miLineCount; i++)
+		{
+			madtLineNumbers[i] = padtDefinition->GetLine(i)->GetLineNumber().GetValue();
+			adtLineSlots[madtLineNumbers[i]] = i;
+		}
+
+		for(AmsInt i = 0; i < padtDefinition->ColumnCount(); i++)
+		{
+			AmsString strColumnNumber = padtDefinition->GetColumn(i)->GetColumnNumber().GetValue();
+			madtColumnSlots[AmsStrToInteger(strColumnNumber)] = madtColumnNumbers.size();
+			madtColumnNumbers.push_back(strColumnNumber);
+		}
+
+		for(AmsInt i = 0; i < miLineCount; i++)
+		{
+			FfsERSystemAssuranceDefinitionLinePtr padtLine = (FfsERSystemAssuranceDefinitionLinePtr) padtDefinition->GetLine(i);
+
+			if(padtLine->LineTotalCount() == 0)
+				continue;
+
+			Total adtTotal;
+			adtTotal.iTarget = i;
+
+			for(AmsInt j = 0; j < padtLine->LineTotalCount(); j++)
+			{
+				FfsERSystemAssuranceDefinitionLineTotalPtr padtLineTotal = padtLine->GetLineTotal(j);
+				map<AmsString, size_t>::iterator it = adtLineSlots.find(padtLineTotal->GetLineNumber().GetValue());
+
+				if(it != adtLineSlots.end())
+					AddTerm(adtTotal, (*it).second, padtLineTotal->DetermineAddOrSubtract());
+			}
+
+			madtLineTotals.push_back(adtTotal);
+		}
+
+		for(AmsInt i = 0; i < padtDefinition->ColumnCount(); i++)
+		{
+			FfsERSystemAssuranceDefinitionColumnPtr padtColumn = (FfsERSystemAssuranceDefinitionColumnPtr) padtDefinition->GetColumn(i);
+
+			if(padtColumn->ColumnTotalCount() == 0)
+				continue;
+
+			Total adtTotal;
+			adtTotal.iTarget = i;
+
+			for(AmsInt j = 0; j < padtColumn->ColumnTotalCount(); j++)
+			{
+				FfsERSystemAssuranceDefinitionColumnTotalPtr padtColumnTotal = padtColumn->GetColumnTotal(j);
+				map<AmsInt, size_t>::iterator it = madtColumnSlots.find(AmsStrToInteger(padtColumnTotal->GetColumnNumber().GetValue()));
+
+				if(it != madtColumnSlots.end())
+					AddTerm(adtTotal, (*it).second, padtColumnTotal->DetermineAddOrSubtract());
+			}
+
+			madtColumnTotals.push_back(adtTotal);
+		}
+
+		AmsInt iCycleLine = Order(madtLineTotals, miLineCount);
+		AmsInt iCycleColumn = Order(madtColumnTotals, madtColumnNumbers.size());
+
+		strCycleLine = (iCycleLine >= 0 ? madtLineNumbers[iCycleLine] : AmsString());
+		strCycleColumn = (iCycleColumn >= 0 ? madtColumnNumbers[iCycleColumn] : AmsString());
+
+		madtIsLineTotal.assign(miLineCount, FALSE);
+
+		for(size_t i = 0; i < madtLineTotals.size(); i++)
+			madtIsLineTotal[madtLineTotals[i].iTarget] = TRUE;
+
+		madtIsColumnTotal.assign(madtColumnNumbers.size(), FALSE);
+
+		for(size_t i = 0; i < madtColumnTotals.size(); i++)
+			madtIsColumnTotal[madtColumnTotals[i].iTarget] = TRUE;
+
+		return (iCycleLine < 0 && iCycleColumn < 0);
+	}
+
+	AmsVoid Reset()
+	{
+		madtAmounts.assign(miLineCount * madtColumnNumbers.size(), 0);
+	}
+
+	// Called by the line workers; each line only touches its own row of the array
+	AmsVoid AddAmount(AmsInt iLineSequence, AmsInt iColumn, double dAmount)
+	{
+		map<AmsInt, size_t>::const_iterator it = madtColumnSlots.find(iColumn);
+
+		if(it != madtColumnSlots.end() && iLineSequence >= 0 && iLineSequence < miLineCount)
+			madtAmounts[iLineSequence * madtColumnNumbers.size() + (*it).second] += dAmount;
+	}
+
+	// Column totals go first on every line that is not itself a total, so that each line total sums them
+	// along with the other columns of its from-lines.  A total replaces whatever was added to its slots, which
+	// is why validation rejects totals that also have source amounts.  A column total reads a few scattered
+	// slots of its own line, so only line totals, which add whole rows, go through AccumulateRow.
+	AmsVoid Evaluate()
+	{
+		const size_t iColumnCount = madtColumnNumbers.size();
+
+		if(madtAmounts.empty())
+			return;
+
+		for(AmsInt i = 0; i < miLineCount; i++)
+		{
+			if(madtIsLineTotal[i])
+				continue;
+
+			double* pdRow = &madtAmounts[0] + i * iColumnCount;
+
+			for(size_t j = 0; j < madtColumnTotals.size(); j++)
+			{
+				const Total& adtTotal = madtColumnTotals[j];
+				double dAmount = 0;
+
+				for(size_t k = 0; k < adtTotal.adtTerms.size(); k++)
+					dAmount += (adtTotal.adtTerms[k].iSign < 0 ? -pdRow[adtTotal.adtTerms[k].iFrom] : pdRow[adtTotal.adtTerms[k].iFrom]);
+
+				pdRow[adtTotal.iTarget] = dAmount;
+			}
+		}
+
+		for(size_t j = 0; j < madtLineTotals.size(); j++)
+		{
+			const Total& adtTotal = madtLineTotals[j];
+			double* pdTarget = &madtAmounts[0] + adtTotal.iTarget * iColumnCount;
+
+			fill(pdTarget, pdTarget + iColumnCount, 0.0);
+
+			for(size_t k = 0; k < adtTotal.adtTerms.size(); k++)
+				AccumulateRow(pdTarget, &madtAmounts[0] + adtTotal.adtTerms[k].iFrom * iColumnCount, iColumnCount, adtTotal.adtTerms[k].iSign);
+		}
+	}
+
+	AmsBoolean IsLineTotal(AmsInt iLineSequence) const
+	{
+		return madtIsLineTotal[iLineSequence];
+	}
+
+	AmsBoolean IsColumnTotal(AmsInt iColumn) const
+	{
+		map<AmsInt, size_t>::const_iterator it = madtColumnSlots.find(iColumn);
+		return (it != madtColumnSlots.end() && madtIsColumnTotal[(*it).second]);
+	}
+
+	size_t ColumnCount() const
+	{
+		return madtColumnNumbers.size();
+	}
+
+	const AmsString& GetColumnNumber(size_t iSlot) const
+	{
+		return madtColumnNumbers[iSlot];
+	}
+
+	double GetAmount(AmsInt iLineSequence, size_t iSlot) const
+	{
+		return madtAmounts[iLineSequence * madtColumnNumbers.size() + iSlot];
+	}
+
+private:
+	enum VisitState
+	{
+		UNVISITED,
+		VISITING,
+		VISITED
+	};
+
+	static AmsVoid AddTerm(Total& adtTotal, size_t iFrom, AmsInt iSign)
+	{
+		Term adtTerm;
+		adtTerm.iFrom = iFrom;
+		adtTerm.iSign = (iSign < 0 ? -1 : 1);
+		adtTotal.adtTerms.push_back(adtTerm);
+	}
+
+	// Adds one row of amounts to another, or subtracts it when iSign is negative.  Each column is still one add
+	// per term in term order, so the vector loop gives the same sums as the scalar one.
+	static AmsVoid AccumulateRow(double* pdTarget, const double* pdFrom, size_t iCount, AmsInt iSign)
+	{
+		size_t c = 0;
+
+#ifdef __AVX__
+		for( ; c + 4 <= iCount; c += 4)
+		{
+			__m256d adtTarget = _mm256_loadu_pd(pdTarget + c);
+			__m256d adtFrom = _mm256_loadu_pd(pdFrom + c);
+
+			adtTarget = (iSign < 0 ? _mm256_sub_pd(adtTarget, adtFrom) : _mm256_add_pd(adtTarget, adtFrom));
+			_mm256_storeu_pd(pdTarget + c, adtTarget);
+		}
+#endif
+
+		for( ; c < iCount; c++)
+			pdTarget[c] += (iSign < 0 ? -pdFrom[c] : pdFrom[c]);
+	}
+
+	// Sorts the totals so that every total comes after the totals it is summed from.  Returns the line or
+	// column of a total found on a cycle, or -1.
+	static AmsInt Order(vector<Total>& adtTotals, size_t iSlotCount)
+	{
+		vector<AmsInt> adtTotalOfSlot(iSlotCount, -1);
+		vector<VisitState> adtStates(adtTotals.size(), UNVISITED);
+		vector<Total> adtOrdered;
+
+		for(size_t i = 0; i < adtTotals.size(); i++)
+			adtTotalOfSlot[adtTotals[i].iTarget] = i;
+
+		for(size_t i = 0; i < adtTotals.size(); i++)
+		{
+			AmsInt iCycle = Visit(i, adtTotals, adtTotalOfSlot, adtStates, adtOrdered);
+
+			if(iCycle >= 0)
+				return iCycle;
+		}
+
+		adtTotals.swap(adtOrdered);
+		return -1;
+	}
+
+	static AmsInt Visit(size_t iTotal, const vector<Total>& adtTotals, const vector<AmsInt>& adtTotalOfSlot,
+						vector<VisitState>& adtStates, vector<Total>& adtOrdered)
+	{
+		if(adtStates[iTotal] == VISITED)
+			return -1;
+
+		if(adtStates[iTotal] == VISITING)
+			return adtTotals[iTotal].iTarget;
+
+		adtStates[iTotal] = VISITING;
+
+		for(size_t k = 0; k < adtTotals[iTotal].adtTerms.size(); k++)
+		{
+			AmsInt iFromTotal = adtTotalOfSlot[adtTotals[iTotal].adtTerms[k].iFrom];
+
+			if(iFromTotal >= 0)
+			{
+				AmsInt iCycle = Visit(iFromTotal, adtTotals, adtTotalOfSlot, adtStates, adtOrdered);
+
+				if(iCycle >= 0)
+					return iCycle;
+			}
+		}
+
+		adtStates[iTotal] = VISITED;
+		adtOrdered.push_back(adtTotals[iTotal]);
+		return -1;
+	}
+
+	AmsInt miLineCount;
+	vector<AmsString> madtLineNumbers;
+	map<AmsInt, size_t> madtColumnSlots;
+	vector<AmsString> madtColumnNumbers;
+	vector<Total> madtLineTotals;
+	vector<Total> madtColumnTotals;
+	vector<AmsBoolean> madtIsLineTotal;
+	vector<AmsBoolean> madtIsColumnTotal;
+	vector<double> madtAmounts;
+};
+
+FfsERSystemAssuranceTotalsGraph madtTotalsGraph;
+
+// Valid parameter groups of one report family, waiting for their report existence check.  The checks run once
+// every family is validated, one union query per family, and the groups are registered in family order.
+struct FfsERSystemAssuranceFamilyValidation
+{
+	AmsString strGroupName;
+	AmsBaseFactory* padtFactory;
+	AmsBoolean bFacts;
+	deque<FfsERSystemAssuranceParameterGroupPtr> adtParameterGroups;
+	exception_ptr adtError;
+};
+
+deque<FfsERSystemAssuranceFamilyValidation> madtFamilyValidations;
+
+// Columns of the groups queued above.  They are not in madtColumnParameters until the checks are done, so
+// ValidateReportColumn looks here too to find a column defined twice.
+set<AmsInt> madtQueuedColumns;
+
+// Current cell of one column reader in the k-way merge done by ProcessLine
+struct FfsERSystemAssuranceMergeEntry
+{
+	FfsERSystemAssuranceReportCellDetailPtr padtCell;
+	AmsInt iColumn;
+	FfsERSystemAssuranceColumnReaderPtr padtColumnReader;
+	FfsERSystemAssuranceParameterGroupPtr padtParameterGroup;
+};
+
+// Puts the lowest cell on top of the merge heap, using the column number to break ties so equal
+// cells come out in column order
+struct FfsERSystemAssuranceMergeEntryGreater
+{
+	bool operator()(const FfsERSystemAssuranceMergeEntry& adtLeft, const FfsERSystemAssuranceMergeEntry& adtRight) const
+	{
+		if(*(adtRight.padtCell) < *(adtLeft.padtCell))
+			return true;
+
+		if(*(adtLeft.padtCell) < *(adtRight.padtCell))
+			return false;
+
+		return adtLeft.iColumn > adtRight.iColumn;
+	}
+};
+
+AmsBoolean
+FfsERSystemAssuranceProcessor::ValidateParameters()
+{
+	madtRunStatistics.Reset();
+	ResetFiscalYearIndexes();
+	FfsERSystemAssurancePhaseTimer adtTimer(FfsERSystemAssuranceRunStatistics::VALIDATION);
+
+	ValidateERSystemAssuranceDefinitionCode();
+	ValidateDefinitionTotals();
+	ValidateDisplayDiscrepanciesOnlyFlag();
+	ValidateExtractionMode();
+	ValidateCriteriaMode();
+	ValidateRowDecodeMode();
+	ValidateFactsAttributeRefresh();
+	ValidateLineWorkerCount();
+	ValidateSaveBatchSize();
+	ValidateWriteQueueSize();
+	ValidateTraceFile();
+	ValidateSlowQueryLog();
+	ValidateCellStreams();
+	ValidateComplexParameters();
+	ValidateTotalSources();
+
+	return IsOK();
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateDefinitionTotals()
+{
+	if(!madtERSystemAssuranceDefinition)
+		return;
+
+	AmsString strCycleLine;
+	AmsString strCycleColumn;
+
+	if(madtTotalsGraph.Build(madtERSystemAssuranceDefinition, strCycleLine, strCycleColumn))
+		return;
+
+	// BJ2041E: Total %1 %2 of report definition %3 is summed from itself
+	if(!strCycleLine.isNull())
+		ReportProblem(AmsProblem("BJ2041E") << "line" << strCycleLine << mstrERSystemAssuranceCode);
+
+	if(!strCycleColumn.isNull())
+		ReportProblem(AmsProblem("BJ2041E") << "column" << strCycleColumn << mstrERSystemAssuranceCode);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateTotalSources()
+{
+	// Total amounts replace the amounts read for their lines and columns, so a total must not have sources of
+	// its own.  Runs after the parameter groups are known.
+	if(!madtERSystemAssuranceDefinition)
+		return;
+
+	map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>::iterator it = madtColumnParameters.begin();
+
+	for( ; it != madtColumnParameters.end(); it++)
+	{
+		// BJ2043E: Total %1 %2 of report definition %3 also has source amounts
+		if(madtTotalsGraph.IsColumnTotal((*it).first))
+			ReportProblem(AmsProblem("BJ2043E") << "column" << AmsULongToStr((*it).first) << mstrERSystemAssuranceCode);
+	}
+
+	for(AmsInt i = 0; i < madtERSystemAssuranceDefinition->LineCount(); i++)
+	{
+		FfsERSystemAssuranceDefinitionLinePtr padtLine =
+			(FfsERSystemAssuranceDefinitionLinePtr) madtERSystemAssuranceDefinition->GetLine(i);
+
+		if(!madtTotalsGraph.IsLineTotal(i) || padtLine->GetAmountsLiteralIndicator().GetValue() != FfsExternalReportAbstractDefinitionLine::AMOUNT)
+			continue;
+
+		for(it = madtColumnParameters.begin(); it != madtColumnParameters.end(); it++)
+		{
+			if(madtERSystemAssuranceDefinition->GetCell(padtLine->GetSectionNumber().GetValue(), padtLine->GetLineNumber().GetValue(),
+				AmsULongToStr((*it).first)))
+			{
+				ReportProblem(AmsProblem("BJ2043E") << "line" << padtLine->GetLineNumber().GetValue() << mstrERSystemAssuranceCode);
+				break;
+			}
+		}
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateExtractionMode()
+{
+	// When set, each column is read with one query covering every line instead of one query per line and column
+	mbColumnMajorExtraction = GetBooleanParameterValue("columnMajorExtraction");
+	ReportBooleanParameterValue("columnMajorExtraction", mbColumnMajorExtraction);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateCriteriaMode()
+{
+	// When set, treasury symbol, fund and bureau criteria are sent as sub-selects against the TSYM and Fund
+	// tables instead of being expanded on the client into one predicate per matching row
+	mbSemiJoinCriteria = GetBooleanParameterValue("semiJoinCriteria");
+	ReportBooleanParameterValue("semiJoinCriteria", mbSemiJoinCriteria);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateRowDecodeMode()
+{
+	// When set, cell details are built straight from the columns of the source rows instead of from a
+	// persistent object per row, and line-major readers only select those columns
+	mbProjectedRowDecode = GetBooleanParameterValue("projectedRowDecode");
+	ReportBooleanParameterValue("projectedRowDecode", mbProjectedRowDecode);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateFactsAttributeRefresh()
+{
+	// FACTS attribute definitions are cached for the life of the process.  When set, the definitions of the
+	// fiscal years this run reads are reloaded, for runs that follow a change to them.
+	mbRefreshFactsAttributes = GetBooleanParameterValue("refreshFactsAttributes");
+	ReportBooleanParameterValue("refreshFactsAttributes", mbRefreshFactsAttributes);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateLineWorkerCount()
+{
+	miLineWorkerCount = GetPositiveIntegerParameter("lineWorkerCount", 1);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateSaveBatchSize()
+{
+	miSaveBatchSize = GetPositiveIntegerParameter("saveBatchSize", DEFAULT_SAVE_BATCH_SIZE);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateWriteQueueSize()
+{
+	miWriteQueueSize = GetPositiveIntegerParameter("writeQueueSize", DEFAULT_WRITE_QUEUE_SIZE);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateTraceFile()
+{
+	// When given, a timeline of the run is written to this file in Chrome trace-event format
+	mstrTraceFile = GetParameterValue("traceFile");
+	ReportParameterValue("traceFile", mstrTraceFile);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateSlowQueryLog()
+{
+	// Readers whose open and fetch time reach the threshold (in milliseconds) are logged to this file
+	mstrSlowQueryLogFile = GetParameterValue("slowQueryLogFile");
+	ReportParameterValue("slowQueryLogFile", mstrSlowQueryLogFile);
+	miSlowQueryThreshold = GetPositiveIntegerParameter("slowQueryThreshold", DEFAULT_SLOW_QUERY_THRESHOLD);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateCellStreams()
+{
+	// The cells decoded from the source readers can be recorded to a file and replayed in a later run of the
+	// same definition and parameters, so merge, cell construction and totals can be profiled without the source queries
+	mstrRecordCellsFile = GetParameterValue("recordCellsFile");
+	ReportParameterValue("recordCellsFile", mstrRecordCellsFile);
+	mstrReplayCellsFile = GetParameterValue("replayCellsFile");
+	ReportParameterValue("replayCellsFile", mstrReplayCellsFile);
+
+	madtCellStreams.Reset();
+
+	if(!mstrRecordCellsFile.isNull() && !mstrReplayCellsFile.isNull())
+	{
+		// BJ2039E: Parameters %1 and %2 cannot be used together
+		ReportProblem(AmsProblem("BJ2039E") << "recordCellsFile" << "replayCellsFile");
+		return;
+	}
+
+	if(!mstrReplayCellsFile.isNull() && !madtCellStreams.Load(mstrReplayCellsFile))
+	{
+		// BJ2040E: File %1 could not be read
+		ReportProblem(AmsProblem("BJ2040E") << mstrReplayCellsFile);
+	}
+}
+
+AmsInt
+FfsERSystemAssuranceProcessor::GetPositiveIntegerParameter(const AmsString& strParameterName, AmsInt iDefault)
+{
+	AmsString strValue = GetParameterValue(strParameterName);
+	ReportParameterValue(strParameterName, strValue);
+
+	if(strValue.isNull())
+		return iDefault;
+
+	AmsInt iValue = AmsStrToInteger(strValue);
+
+	if(iValue < 1)
+	{
+		// BJ0018E: Invalid %1 specified: %2
+		ReportProblem(AmsProblem("BJ0018E") << strParameterName << strValue);
+		return iDefault;
+	}
+
+	return iValue;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateComplexParameters()
+{
+	ValidateBalanceSheet();
+	ValidateBudgetaryResources();
+	ValidateChangesInNetPosition();
+	ValidateCustodialActivity();
+	ValidateFinancing();   
+	ValidateNetCost();
+	ValidateSF133();   
+	ValidateFacts1Adjusted();
+	ValidateFacts1Preliminary();
+	ValidateFacts2Adjusted();
+	ValidateFacts2Preliminary();
+	CheckReportFamiliesExistence();
+	ValidateGLRollup();
+	ValidateComplexParameterExists();
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateERSystemAssuranceDefinitionCode()
+{
+	AmsString strERSystemAssuranceCode = GetParameterValue("ERSystemAssuranceCode");
+	strERSystemAssuranceCode.toUpper();
+	ReportParameterValue("ERSystemAssuranceCode", strERSystemAssuranceCode);
+
+	if (strERSystemAssuranceCode.isNull())
+	{
+		// BA0041E - Parameter %1 is required; hence a value must be entered
+		ReportProblem(AmsProblem("BA0041E") << "ERSystemAssuranceCode");
+		return;
+	}
+
+	mstrERSystemAssuranceCode = strERSystemAssuranceCode;
+	madtERSystemAssuranceDefinition = GetERSystemAssuranceDefinition();
+
+	if (!madtERSystemAssuranceDefinition)
+	{
+		// BJ0018E: Invalid %1 specified: %2
+		ReportProblem(AmsProblem("BJ0018E") << "ERSystemAssuranceCode" << strERSystemAssuranceCode);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateDisplayDiscrepanciesOnlyFlag()
+{
+	mbDisplayDiscrepanciesOnlyFlag = GetBooleanParameterValue ("displayDiscrepanciesOnly");
+	ReportBooleanParameterValue ("displayDiscrepanciesOnly", mbDisplayDiscrepanciesOnlyFlag);
+
+	if(mbDisplayDiscrepanciesOnlyFlag)
+	{
+		AmsBoolean mbTotalExists;  = FALSE;
+
+		for(AmsInt i = 0; i < madtERSystemAssuranceDefinition.Column Count; i++)
+		{
+			ERSystemAssuranceDefinitionColumnPtr padtColumn = padtParentDefinition.Get Column(i);
+
+			if(padtColumn->GetAmountsLiteralIndicator().GetValue() == FfsExternalReportAbstractDefinitionColumn::CURRENT_YEAR_TOTAL)
+			{
+				mbTotalExists = TRUE;
+				return;
+			}
+		}
+
+		if(!mbTotalExists)
+		{
+			// BJ2036E: The displayDiscrepanciesOnly parameter cannot be True if a Total 
+			//Column does not exist on the ER System Assurance Definition specified
+			ReportProblem(AmsProblem("BJ2036E"));
+		}
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateComplexParameterExists()
+{
+	if(!mbComplexParameterEntered)
+	{
+		// BJ2028E: At least one Batch Group Parameter must be entered if 
+		//there are values entered in the Simple Parameters
+		ReportProblem(AmsProblem("BJ2028E"));
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateReportColumn(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
+{
+	AmsInt iColumnNumber = AmsStrToInteger(padtParameterGroup->GetColumnNumber())
+
+		if(madtColumnParameters.find(iColumnNumber) != madtColumnParameters.end() || madtQueuedColumns.count(iColumnNumber))
+		{
+			//Parameters already defined for report column %1
+			AddProblem("BJ2032E") << strColumnNumber;
+		}
+
+	FfsERSystemAssuranceDefinitionColumnPtr padtColumn = padtParameterGroup->GetColumnObj();
+
+		if(padtColumn)
+		{
+		if(padtParameterGroup->GetGroupName() != padtColumn.GetReportType.GetValue())
+			{
+				//BJ2035E Column Number %1 entered for Report Type %2 does not match a column 
+				//number defined in ER System Assurance Definition %3 for the matching Report Type
+			ReportProblem(AmsProblem("BJ2035E") << padtParameterGroup->GetColumnNumber() << padtParameterGroup->GetGroupName()
+				<< mstrERSystemAssuranceCode);
+			}
+
+		AmsString strColumnReportCode = padtColumn->GetReportDefintionByType(padtParameterGroup->GetGroupName());
+
+		if(!strColumnReportCode.isNull() && padtParameterGroup->GetReportCode() != strColumnReportCode)
+			{
+				//BJ2033E Report Code %1 entered for Batch Group %2 does not match the Report 
+				//Code defined in ER System Assurance Definition %3 for Column %4
+			ReportProblem(AmsProblem("BJ2033E") << padtParameterGroup->GetReportCode() << padtParameterGroup->GetGroupName()
+				<< mstrERSystemAssuranceCode << padtParameterGroup->GetColumnNumber());
+			}		
+		}
+		else
+		{
+			//BJ2035E Column Number %1 entered for Report Type %2 does not match a column 
+			//number defined in ER System Assurance Definition %3 for the matching Report Type
+		ReportProblem(AmsProblem("BJ2035E") << padtParameterGroup->GetColumnNumber() << padtParameterGroup->GetGroupName()
+			<< mstrERSystemAssuranceCode);
+		}
+}
+
+AmsBoolean
+FfsERSystemAssuranceProcessor::ValidateParameterGroup(FfsERSystemAssuranceParmeterGroupPtr padtParameterGroup)
+{
+	if(!padtParameterGroup->GetColumnNumber().isNull() || !padtParameterGroup->GetFiscalMonth().isNull() ||
+		!padtParameterGroup->GetFiscalQuarter().isNull() || !padtParameterGroup->GetFiscalYear().isNull() ||
+		!padtParameterGroup->GetReportCode().isNull() || !padtParameterGroup->GetReportVersion().isNull() ||
+		!padtParameterGroup->GetAgency().isNull()))
+	{
+		if(padtParameterGroup->GetColumnNumber().isNull()  || padtParameterGroup->GetFiscalYear().isNull())
+		{
+			if(padtParameterGroup->IsGLRollup())
+			{
+				if(padtParameterGroup->GetAgency().isNull())
+				{
+					//BJ2029E:  The following parameter values are required for the %1 group:  Agency, 
+					//Fiscal Year and ER System Assurance Column Number.
+					ReportProblem(AmsProblem("BJ2029E") << padtParameterGroup->GetGroupName());
+				}
+			}
+			else
+			{
+				if(padtParameterGroup->GetReportCode().isNull() || padtParameterGroup->GetReportVersion().isNull())
+				{
+					//BJ2034E:  The following parameter values are required for the %1 group:  Report Code, 
+					//Fiscal Year, Report Version and ER System Assurance Column Number.
+					ReportProblem(AmsProblem("BJ2034E") << padtParameterGroup->GetGroupName());
+				}
+			}
+		}
+
+		if(!padtParameterGroup->GetFiscalQuarter().isNull() && !padtParameterGroup->GetFiscalMonth().isNull())
+		{
+			//BJ0351E:  The Fiscal Quarter and Fiscal Month cannot both be specified.
+			ReportProblem(AmsProblem("BJ0351E"));
+		}
+
+		mbComplexParameterEntered = TRUE;
+	}
+	else
+	{
+		delete padtParameterGroup;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateReportParameters(const AmsString& strGroupName, AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
+{
+	AmsInt iParamGroupCount = NumberOfParameterGroups(strGroupName);
+
+	// The reports of all groups of the family are resolved with one query, run by CheckReportFamiliesExistence
+	madtFamilyValidations.push_back(FfsERSystemAssuranceFamilyValidation());
+	FfsERSystemAssuranceFamilyValidation& adtValidation = madtFamilyValidations.back();
+	adtValidation.strGroupName = strGroupName;
+	adtValidation.padtFactory = &adtFactory;
+	adtValidation.bFacts = FALSE;
+
+	for (AmsInt iGroupNumber = 0; iGroupNumber < iParamGroupCount; iGroupNumber++) 
+	{
+		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = PopulateParameterGroup(strGroupName, iGroupNumber, adtFactory, adtDetailFactory);
+		ValidateReportColumn(padtParameterGroup);
+
+		if(ValidateParameterGroup(padtParameterGroup))
+		{
+			adtValidation.adtParameterGroups.push_back(padtParameterGroup);
+			madtQueuedColumns.insert(AmsStrToInteger(padtParameterGroup->GetColumnNumber()));
+		}
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateFactsReportParameters(const AmsString& strGroupName, AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
+{
+	AmsInt iParamGroupCount = NumberOfParameterGroups(strGroupName);
+
+	// The reports of all groups of the family are resolved with one query, run by CheckReportFamiliesExistence
+	madtFamilyValidations.push_back(FfsERSystemAssuranceFamilyValidation());
+	FfsERSystemAssuranceFamilyValidation& adtValidation = madtFamilyValidations.back();
+	adtValidation.strGroupName = strGroupName;
+	adtValidation.padtFactory = &adtFactory;
+	adtValidation.bFacts = TRUE;
+
+	for (AmsInt iGroupNumber = 0; iGroupNumber < iParamGroupCount; iGroupNumber++) 
+	{
+		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = PopulateParameterGroup(strGroupName, iGroupNumber, adtFactory, adtDetailFactory);
+		ValidateReportColumn(padtParameterGroup);
+
+		if(ValidateParameterGroup(padtParameterGroup))
+		{
+			adtValidation.adtParameterGroups.push_back(padtParameterGroup);
+			madtQueuedColumns.insert(AmsStrToInteger(padtParameterGroup->GetColumnNumber()));
+		}
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateGLRollupParameters(const AmsString& strGroupName, AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
+{
+	AmsInt iParamGroupCount = NumberOfParameterGroups(strGroupName);
+	for (AmsInt iGroupNumber = 0; iGroupNumber < iParamGroupCount; iGroupNumber++) 
+	{
+		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = PopulateGLParameterGroup(strGroupName, iGroupNumber, adtFactory, adtDetailFactory);
+		ValidateReportColumn(padtParameterGroup);
+
+		if(ValidateParameterGroup(padtParameterGroup))
+		{
+			RegisterParameterGroup(padtParameterGroup);
+		}
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateBalanceSheet()
+{
+	ValidateReportParameters(FfsERSystemAssuranceDefinition::BALANCE_SHEET, GetPOFactory(FfsFormAndContentBalanceSheetReport),
+		GetPOFactory(FfsFormAndContentBalanceSheetReportCell));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateBudgetaryResources()
+{
+	ValidateReportParameters(FfsERSystemAssuranceDefinition::BUDGETARY_RESOURCES, GetPOFactory(FfsFormAndContentBudgetaryResourcesReport),
+		GetPOFactory(FfsFormAndContentBudgetaryResourcesReportCell));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateChangesInNetPosition()
+{
+	ValidateReportParameters(FfsERSystemAssuranceDefinition::CHANGES_IN_NET_POSITION, GetPOFactory(FfsFormAndContentChangesInNetPositionReport),
+		GetPOFactory(FfsFormAndContentChangesInNetPositionReportCell));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateCustodialActivity()
+{
+	ValidateReportParameters(FfsERSystemAssuranceDefinition::CUSTODIAL_ACTIVITY, GetPOFactory(FfsFormAndContentCustodialActivityReport),
+		GetPOFactory(FfsFormAndContentCustodialActivityReportCell));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateFinancing()
+{
+	ValidateReportParameters(FfsERSystemAssuranceDefinition::FINANCING, GetPOFactory(FfsFormAndContentFinancingReport), 
+		GetPOFactory(FfsFormAndContentFinancingReportCell));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateNetCost()
+{
+	ValidateReportParameters(FfsERSystemAssuranceDefinition::NET_COST, GetPOFactory(FfsFormAndContentNetCostReport),
+		GetPOFactory(FfsFormAndContentNetCostReportCell));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateSF133()
+{
+	ValidateReportParameters(FfsERSystemAssuranceDefinition::SF133, GetPOFactory(FfsExternalReport133Report),
+		GetPOFactory(FfsExternalReport133ReportCell));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateFacts1Adjusted()
+{
+	ValidateFactsReportParameters(FfsERSystemAssuranceDefinition::FACTS_I_ADJUSTED, GetPOFactory(FfsFacts1AdjustedTrialBalanceReport),
+		GetPOFactory(FfsFacts1AdjustedTrialBalanceReportDetail));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateFacts1Preliminary()
+{
+	ValidateFactsReportParameters(FfsERSystemAssuranceDefinition::FACTS_I_PRELIMINARY, GetPOFactory(FfsFacts1PreliminaryTrialBalanceReport),
+		GetPOFactory(FfsFacts1PreliminaryTrialBalanceReportDetail));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateFacts2Adjusted()
+{
+	ValidateFactsReportParameters(FfsERSystemAssuranceDefinition::FACTS_II_ADJUSTED, GetPOFactory(FfsFacts2AdjustedTrialBalanceReport),
+		GetPOFactory(FfsFacts2AdjustedTrialBalanceReportDetail));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateFacts2Preliminary()
+{
+	ValidateFactsReportParameters(FfsERSystemAssuranceDefinition::FACTS_II_PRELIMINARY, GetPOFactory(FfsFacts2PreliminaryTrialBalanceReport),
+		GetPOFactory(FfsFacts2PreliminaryTrialBalanceReportDetail));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ValidateGLRollup()
+{
+	// initially assume that we will need the factory with the lowest level of detail
+	// we will recalculate this to use the most efficient factory later
+	ValidateGLRollupParameters(FfsERSystemAssuranceDefinition::GL_ROLLUP, GetPOFactory(FfsGLAcctAnnualBalByVendor), GetPOFactory(FfsGLAcctAnnualBalByVendor));
+}
+
+FfsERSystemAssuranceParameterGroupPtr
+FfsERSystemAssuranceProcessor::PopulateBasicParameterGroup(const AmsString& strGroupName, const AmsInt& iGroupNumber, 
+														   AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
+{
+	FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = new FfsERSystemAssuranceParameterGroup;
+	padtParameterGroup->SetGroupName(strGroupName);
+	padtParameterGroup->SetFactory(&adtFactory);
+	padtParameterGroup->SetDetailFactory(&adtDetailFactory);
+	padtParameterGroup->SetColumnNumber(GetAndReportParameter("erSystemAssuranceColumnNumber" , strGroupName, iGroupNumber));
+	padtParameterGroup->SetFiscalMonth(GetAndReportParameter("fiscalMonth", strGroupName, iGroupNumber));
+	padtParameterGroup->SetFiscalQuarter(GetAndReportParameter("fiscalQuarter", strGroupName, iGroupNumber));
+	padtParameterGroup->SetFiscalYear(GetAndReportParameter("fiscalYear", strGroupName, iGroupNumber));
+
+    FfsERsystemAssuranceDefinitionColumnPtr padtColumn = madtERSystemAssuranceDefinition->GetColumn(padtParameterGroup->GetColumnNumber());
+    padtParameterGroup->SetColumnId(padtColumn->GetIdentityAspect());
+
+	return padtParameterGroup;
+}
+
+FfsERSystemAssuranceParameterGroupPtr
+FfsERSystemAssuranceProcessor::PopulateParameterGroup(const AmsString& strGroupName, const AmsInt& iGroupNumber, 
+													  AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
+{
+	FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = PopulateBasicParameterGroup(strGroupName, iGroupNumber, adtFactory, adtDetailFactory);
+	padtParameterGroup->SetReportCode(GetAndReportParameter("reportCode", strGroupName, iGroupNumber));
+	padtParameterGroup->SetReportVersion(GetAndReportParameter("reportVersion", strGroupName, iGroupNumber));
+	return padtParameterGroup;
+}
+
+FfsERSystemAssuranceParameterGroupPtr
+FfsERSystemAssuranceProcessor::PopulateGLParameterGroup(const AmsString& strGroupName, const AmsInt& iGroupNumber, AmsBaseFactory& adtFactory, AmsBaseFactory& adtDetailFactory)
+{
+	FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = PopulateBasicParameterGroup(strGroupName, iGroupNumber, adtFactory, adtDetailFactory);
+	padtParameterGroup->SetAgency(GetAndReportParameter("agency", strGroupName, iGroupNumber));
+	return padtParameterGroup;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::CheckReportFamiliesExistence()
+{
+	if(mbRefreshFactsAttributes)
+		InvalidateFactsAttributeCache();
+
+	// The queries run on the main connection, one family at a time.  A family whose query fails is reported and
+	// dropped, and the other families are still checked.
+	for(AmsInt i = 0; i < madtFamilyValidations.size(); i++)
+	{
+		FfsERSystemAssuranceFamilyValidation& adtValidation = madtFamilyValidations[i];
+
+		if(!adtValidation.adtParameterGroups.size())
+			continue;
+
+		try
+		{
+			if(adtValidation.bFacts)
+				CheckFactsReportExistence(adtValidation.adtParameterGroups, *adtValidation.padtFactory);
+			else
+				CheckReportExistence(adtValidation.adtParameterGroups, *adtValidation.padtFactory);
+		}
+		catch(...)
+		{
+			adtValidation.adtError = current_exception();
+		}
+
+		if(adtValidation.adtError)
+			ReportExistenceCheckError(adtValidation);
+		else
+			AddExistingReportParameterGroups(adtValidation.adtParameterGroups);
+	}
+
+	madtFamilyValidations.clear();
+	madtQueuedColumns.clear();
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ReportExistenceCheckError(FfsERSystemAssuranceFamilyValidation& adtValidation)
+{
+	AmsString strError = "unknown error";
+
+	try
+	{
+		rethrow_exception(adtValidation.adtError);
+	}
+	catch(const exception& adtException)
+	{
+		strError = adtException.what();
+	}
+	catch(...)
+	{
+	}
+
+	// BJ2044E: The reports of %1 could not be checked for %2: %3
+	ReportProblem(AmsProblem("BJ2044E") << adtValidation.strGroupName << mstrERSystemAssuranceCode << strError);
+
+	// Whatever the query matched before it failed is not trusted, so none of the family's groups are used
+	for(AmsInt i = 0; i < adtValidation.adtParameterGroups.size(); i++)
+		delete adtValidation.adtParameterGroups[i];
+
+	adtValidation.adtParameterGroups.clear();
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::CheckReportExistence(deque<FfsERSystemAssuranceParameterGroupPtr>& adtParameterGroups, AmsBaseFactory& adtFactory)
+{
+	// The criteria of every group form one branch of a union, tagged with the group's index, so a row is given
+	// to its group without comparing its values to the parameters
+	AmsDBSelector adtSelector;
+
+	for(AmsInt i = 0; i < adtParameterGroups.size(); i++)
+	{
+		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = adtParameterGroups[i];
+		FfsExternalReportAbstractReportPtr padtSelect = (FfsExternalReportAbstractReportPtr)adtFactory.SelectCriteriaAb();
+		padtSelect->SetCode(padtParameterGroup->GetReportCode());
+		padtSelect->SetVersion(padtParameterGroup->GetReportVersion());
+		padtSelect->SetReportingMonth(padtParameterGroup->GetFiscalMonth());
+		padtSelect->SetReportingQuarter(padtParameterGroup->GetFiscalQuarter());
+		padtSelect->SetReportingYear(padtParameterGroup->GetFiscalYear());
+
+		AmsDBSelector adtGroupSelector;
+		adtFactory.GetStorage()->SelectAllWhere(adtGroupSelector, padtSelect);
+		adtGroupSelector << AmsDBLiteral(AmsIntToStr(i)).as(GROUP_INDEX_COLUMN);
+		delete padtSelect;
+
+		if(i)
+			adtSelector.unionAll(adtGroupSelector);
+		else
+			adtSelector = adtGroupSelector;
+	}
+
+	// The first row of a group is the one used, so the rows of a group come lowest report id first
+	adtSelector.orderBy(GROUP_INDEX_COLUMN + ", UIDY");
+
+	AmsPartialQueryInfoPtr padtPartialQueryInfo = CreateReportExistenceQueryInfo(adtFactory);
+	AmsReaderPtr padtReader = OpenReaderWhere(adtFactory, adtSelector, padtPartialQueryInfo);
+
+	while(padtReader->NextRow())
+	{
+		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = adtParameterGroups[AmsStrToInteger(padtReader->GetColumnValue(GROUP_INDEX_COLUMN))];
+
+		// The report with the lowest id is the one used
+		if(!padtParameterGroup->GetReportId().isNull())
+			continue;
+
+		// Every cell read for the group belongs to this report, so its partition is kept for the cell details
+		padtParameterGroup->SetReportId(padtReader->GetColumnValue("UIDY"));
+		padtParameterGroup->SetReportPartition(padtReader->GetColumnValue("PATN"));
+	}
+
+	delete padtReader;
+	delete padtPartialQueryInfo;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::CheckFactsReportExistence(deque<FfsERSystemAssuranceParameterGroupPtr>& adtParameterGroups, AmsBaseFactory& adtFactory)
+{
+	// The criteria of every group form one branch of a union, tagged with the group's index, so a row is given
+	// to its group without comparing its values to the parameters
+	AmsDBSelector adtSelector;
+
+	for(AmsInt i = 0; i < adtParameterGroups.size(); i++)
+	{
+		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = adtParameterGroups[i];
+		FfsFactsAbstractReportPtr padtSelect = (FfsFactsAbstractReportPtr)adtFactory.SelectCriteriaAb();
+		padtSelect->SetCode(padtParameterGroup->GetReportCode());
+		padtSelect->SetVersion(padtParameterGroup->GetReportVersion());
+		padtSelect->SetReportingMonth(padtParameterGroup->GetFiscalMonth());
+		padtSelect->SetReportingQuarter(padtParameterGroup->GetFiscalQuarter());
+		padtSelect->SetReportingYear(padtParameterGroup->GetFiscalYear());
+
+		AmsDBSelector adtGroupSelector;
+		adtFactory.GetStorage()->SelectAllWhere(adtGroupSelector, padtSelect);
+		adtGroupSelector << AmsDBLiteral(AmsIntToStr(i)).as(GROUP_INDEX_COLUMN);
+		delete padtSelect;
+
+		if(i)
+			adtSelector.unionAll(adtGroupSelector);
+		else
+			adtSelector = adtGroupSelector;
+	}
+
+	// The first row of a group is the one used, so the rows of a group come lowest report id first
+	adtSelector.orderBy(GROUP_INDEX_COLUMN + ", UIDY");
+
+	AmsPartialQueryInfoPtr padtPartialQueryInfo = CreateReportExistenceQueryInfo(adtFactory);
+	AmsReaderPtr padtReader = OpenReaderWhere(adtFactory, adtSelector, padtPartialQueryInfo);
+
+	while(padtReader->NextRow())
+	{
+		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = adtParameterGroups[AmsStrToInteger(padtReader->GetColumnValue(GROUP_INDEX_COLUMN))];
+
+		// The report with the lowest id is the one used
+		if(!padtParameterGroup->GetReportId().isNull())
+			continue;
+
+		padtParameterGroup->SetReportId(padtReader->GetColumnValue("UIDY"));
+
+		// Resolved once here so the cell builder reads the trading partner with a single indexed accessor
+		padtParameterGroup->SetTradingPartnerAttributeIndex(GetFactsAttributeIndex(GetFactsAttributeNumber(
+			(padtParameterGroup->IsFacts1Report() ? "TRDG_PTNR_AGCY_FL" : "TRFR_AGCY_ACCT_FL"), padtParameterGroup)));
+	}
+
+	delete padtReader;
+	delete padtPartialQueryInfo;
+}
+
+AmsPartialQueryInfoPtr
+FfsERSystemAssuranceProcessor::CreateReportExistenceQueryInfo(AmsBaseFactory& adtFactory)
+{
+	// Only what is needed to read the group's cells; the group of a row comes from its union branch
+	const char* apcAspects[] = { "identity", "partition" };
+	AmsPartialQueryInfoPtr padtPartialQueryInfo = new AmsPartialQueryInfo;
+
+	for(AmsInt i = 0; i < sizeof(apcAspects) / sizeof(apcAspects[0]); i++)
+		padtPartialQueryInfo->SetQueryAspect(adtFactory.GetStorage()->GetColumnIndexForPartialSelect(apcAspects[i]), AmsSQLHelper::NONE);
+
+	return padtPartialQueryInfo;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddExistingReportParameterGroups(deque<FfsERSystemAssuranceParameterGroupPtr>& adtParameterGroups)
+{
+	for(AmsInt i = 0; i < adtParameterGroups.size(); i++)
+	{
+		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = adtParameterGroups[i];
+
+		if(padtParameterGroup->GetReportId().isNull())
+		{
+			//BJ2026E The Report Version for Report Type %1 does not exist, 
+			//therefore no Query Records were created for %2 
+			ReportProblem(AmsProblem("BJ2026E") << padtParameterGroup->GetGroupName() << mstrERSystemAssuranceCode);
+			delete padtParameterGroup;
+		}
+		else if(padtParameterGroup->IsFactsAbstractExternalReport() && padtParameterGroup->GetTradingPartnerAttributeIndex() < 0 &&
+			ColumnSelectsTradingPartners(padtParameterGroup->GetColumnNumber()))
+		{
+			// BJ2045E: No FACTS attribute of %1 holds the trading partner that column %2 of report definition %3 selects by
+			ReportProblem(AmsProblem("BJ2045E") << padtParameterGroup->GetGroupName() << padtParameterGroup->GetColumnNumber()
+				<< mstrERSystemAssuranceCode);
+			delete padtParameterGroup;
+		}
+		else
+			RegisterParameterGroup(padtParameterGroup);
+	}
+
+	adtParameterGroups.clear();
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::RegisterParameterGroup(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
+{
+	AmsInt iColumnNumber = AmsStrToULong(padtParameterGroup->GetColumnNumber());
+
+	// ValidateReportColumn has already reported BJ2032E for a second group of the column; the first one is kept
+	if(madtColumnParameters.find(iColumnNumber) != madtColumnParameters.end())
+	{
+		delete padtParameterGroup;
+		return;
+	}
+
+	madtColumnParameters[iColumnNumber] = padtParameterGroup;
+}
+
+AmsBoolean
+FfsERSystemAssuranceProcessor::ColumnSelectsTradingPartners(const AmsString& strColumnNumber)
+{
+	// Line trading partners only apply to the lines that have a cell in the column
+	for(AmsInt i = 0; i < madtERSystemAssuranceDefinition->LineCount(); i++)
+	{
+		FfsERSystemAssuranceDefinitionLinePtr padtLine =
+			(FfsERSystemAssuranceDefinitionLinePtr) madtERSystemAssuranceDefinition->GetLine(i);
+
+		if(padtLine->GetAmountsLiteralIndicator().GetValue() != FfsExternalReportAbstractDefinitionLine::AMOUNT)
+			continue;
+
+		FfsERSystemAssuranceDefinitionCellPtr padtCell = madtERSystemAssuranceDefinition->GetCell(padtLine->GetSectionNumber().GetValue(),
+			padtLine->GetLineNumber().GetValue(), strColumnNumber);
+
+		if(padtCell && (padtLine->GetTradingPartners()->Size() || padtCell->GetTradingPartners()->Size()))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+AmsInt
+FfsERSystemAssuranceProcessor::GetFactsAttributeIndex(const AmsString& strAttributeNumber)
+{
+	if(strAttributeNumber.isNull())
+		return -1;
+
+	AmsInt iIndex = AmsStrToInteger(strAttributeNumber) - 1;
+
+	return (iIndex >= 0 && iIndex < FACTS_ATTRIBUTE_COUNT ? iIndex : -1);
+}
+
+AmsULong
+FfsERSystemAssuranceProcessor::GenerateVersionNumber()
+{
+	AmsULong ulVersion;
+
+	FfsERSystemAssuranceReportPtr padtCriteria = (FfsERSystemAssuranceReportPtr)(GetFactory().SelectCriteriaAb());
+	padtCriteria->SetCode(mstrERSystemAssuranceCode);
+
+	AmsDBSelector adtSelector;
+	GetFactory().GetStorage()->SelectAllWhere(adtSelector, padtCriteria);
+
+	AmsPartialQueryInfoPtr padtPartialQueryInfo = new AmsPartialQueryInfo;
+	AmsInt iAspect = GetFactory().GetStorage()->GetColumnIndexForPartialSelect("version");
+	padtPartialQueryInfo->SetQueryAspect(iAspect, AmsSQLHelper::MAX);
+
+	AmsReaderPtr padtReader = GetFactory().GetPartialReaderWhere(adtSelector, padtPartialQueryInfo);
+
+	if(padtReader->NextRow())
+	{
+		FfsERSystemAssuranceReportPtr padtResult = (FfsERSystemAssuranceReportPtr)(GetFactory().CreateSingleInstanceAb(padtReader));
+		ulVersion = padtResult->GetVersion().GetValue() + 1;
+		delete padtResult;
+	}
+	else
+		ulVersion = 1;
+
+	delete padtCriteria;
+	delete padtPartialQueryInfo;
+}
+
+FfsERSystemAssuranceDefinitionPtr 
+FfsERSystemAssuranceProcessor::GetERSystemAssuranceDefinition()
+{
+	FfsERSystemAssuranceDefinition madtERSystemAssuranceRef;
+	madtERSystemAssuranceRef.SetCodeAspect(mstrERSystemAssuranceCode);
+	madtERSystemAssuranceRef.AsIdentity();
+	return madtERSystemAssuranceRef.GetERSystemAssuranceObj();
+}
+
+AmsString
+FfsERSystemAssuranceProcessor::GetAndReportParameter(const AmsString& strParameterName, const AmsString& strGroupName, const AmsInt iGroup)
+{
+	AmsString strReturn = GetParameterValue( strParameterName, strGroupName, iGroup );
+	ReportParameterValue(strGroupName, strParameterName, strReturn, iGroup);
+	return strReturn; 
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::Process()
+{
+	if(!mstrTraceFile.isNull())
+		madtTracer.Start();
+
+	if(!mstrSlowQueryLogFile.isNull() && !madtSlowQueryLog.Open(mstrSlowQueryLogFile, miSlowQueryThreshold))
+	{
+		// BJ2038W: File %1 could not be written
+		ReportProblem(AmsProblem("BJ2038W") << mstrSlowQueryLogFile);
+	}
+
+	if(!mstrRecordCellsFile.isNull())
+		madtCellStreams.StartRecording();
+
+	try
+	{
+		ProcessReport();
+	}
+	catch(...)
+	{
+		// None of the run's diagnostics may stay switched on for a later run in the process
+		madtSlowQueryLog.Close();
+		madtCellStreams.Reset();
+		madtTracer.Stop();
+		throw;
+	}
+
+	madtSlowQueryLog.Close();
+
+	if(madtCellStreams.IsRecording() && !madtCellStreams.Write(mstrRecordCellsFile))
+	{
+		// BJ2038W: File %1 could not be written
+		ReportProblem(AmsProblem("BJ2038W") << mstrRecordCellsFile);
+	}
+
+	const set< pair<AmsString, AmsInt> >& adtMissingStreams = madtCellStreams.GetMissingStreams();
+
+	for(set< pair<AmsString, AmsInt> >::const_iterator it = adtMissingStreams.begin(); it != adtMissingStreams.end(); it++)
+	{
+		// BJ2042W: File %1 has no cells recorded for line %2 column %3 with the current definition and parameters
+		ReportProblem(AmsProblem("BJ2042W") << mstrReplayCellsFile << (*it).first << AmsIntToStr((*it).second));
+	}
+
+	madtCellStreams.Reset();
+
+	if(madtTracer.IsEnabled())
+	{
+		if(!madtTracer.Write(mstrTraceFile))
+		{
+			// BJ2038W: File %1 could not be written
+			ReportProblem(AmsProblem("BJ2038W") << mstrTraceFile);
+		}
+
+		madtTracer.Stop();
+	}
+
+	// BJ2037I: Run statistics: %1
+	ReportProblem(AmsProblem("BJ2037I") << madtRunStatistics.ToJson(madtReferenceCache.GetHits(), madtReferenceCache.GetMisses()));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ProcessReport()
+{
+	FfsERSystemAssurancePhaseTimer adtTimer(FfsERSystemAssuranceRunStatistics::RUN);
+
+	// Report details are written behind extraction by a separate writer thread
+	FfsERSystemAssuranceWriter adtWriter(miWriteQueueSize, miSaveBatchSize);
+	mpadtWriter = &adtWriter;
+
+	FfsERSystemAssuranceReportPtr padtNewReport = GetPOFactory(FfsERSystemAssuranceReport).NewInstance();
+
+	try
+	{
+		PopulateReportHeader(padtNewReport);
+		PopulateReportParameters(padtNewReport);
+		LoadReferenceCache();
+		LoadDefinitionIndex();
+		madtTotalsGraph.Reset();
+
+		// Amount lines are independent of each other, so they may be processed by several workers.  The report
+		// lines are collected by definition line and added in definition order before totals and rounding.
+		vector<FfsERSystemAssuranceReportLinePtr> adtReportLines(madtERSystemAssuranceDefinition->LineCount(), NULL);
+		ProcessAmountLines(padtNewReport, adtReportLines);
+
+		{
+			FfsERSystemAssurancePhaseTimer adtTotalsTimer(FfsERSystemAssuranceRunStatistics::TOTALS);
+			madtTotalsGraph.Evaluate();
+		}
+
+		for(AmsInt i = 0; i < madtERSystemAssuranceDefinition->LineCount(); i++)
+		{
+			FfsERSystemAssuranceDefinitionLinePtr padtLine =
+				(FfsERSystemAssuranceDefinitionLinePtr) madtERSystemAssuranceDefinition->GetLine(i);
+
+			if(padtLine->GetAmountsLiteralIndicator().GetValue() == FfsExternalReportAbstractDefinitionLine::AMOUNT)
+			{
+				if(adtReportLines[i])
+				{
+					FillReportLine(adtReportLines[i], i);
+					padtNewReport->AddLine(adtReportLines[i]);
+				}
+			}
+			else if(madtTotalsGraph.IsLineTotal(i))
+				padtNewReport->AddLine(CreateTotalsLine(padtNewReport, padtLine, i));
+		}
+
+		{
+			FfsERSystemAssurancePhaseTimer adtRoundingTimer(FfsERSystemAssuranceRunStatistics::ROUNDING);
+			padtNewReport->RoundAmounts(madtERSystemAssuranceDefinition);
+		}
+
+		// massage data if display discrepancies only is selected
+		HandleDisplayDiscrepancies(padtNewReport);
+
+		// Everything queued has to be written before the report itself.  The report is saved on the writer's
+		// connection, so the report and its details are committed together once all of them have been written.
+		adtWriter.Finish();
+		mpadtWriter = NULL;
+		madtRowProjections.Clear();
+
+		{
+			FfsERSystemAssurancePhaseTimer adtSaveTimer(FfsERSystemAssuranceRunStatistics::SAVE);
+			FfsERSystemAssuranceTraceSpan adtSpan("saveReport");
+			padtNewReport->Save(adtWriter.GetConnection());
+		}
+
+		adtWriter.Commit();
+	}
+	catch(...)
+	{
+		// The writer rolls back what it has written when it goes out of scope
+		mpadtWriter = NULL;
+		madtRowProjections.Clear();
+		delete padtNewReport;
+		throw;
+	}
+
+	delete padtNewReport;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::LoadReferenceCache()
+{
+	// Rows of later fiscal years than any report column asks for cannot turn up in the source data
+	AmsString strLastFiscalYear;
+	map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>::iterator it = madtColumnParameters.begin();
+
+	for( ; it != madtColumnParameters.end(); it++)
+	{
+		AmsString strFiscalYear = (*it).second->GetFiscalYear();
+
+		if(strLastFiscalYear.isNull() || strLastFiscalYear < strFiscalYear)
+			strLastFiscalYear = strFiscalYear;
+	}
+
+	FfsERSystemAssuranceTraceSpan adtSpan("loadReferenceCache");
+	madtReferenceCache.Load(strLastFiscalYear);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::LoadDefinitionIndex()
+{
+	FfsERSystemAssuranceTraceSpan adtSpan("loadDefinitionIndex");
+	madtDefinitionIndex.Build(madtERSystemAssuranceDefinition, madtColumnParameters);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ProcessAmountLines(FfsERSystemAssuranceReportPtr padtNewReport, vector<FfsERSystemAssuranceReportLinePtr>& adtReportLines)
+{
+	// Split the definition into the units of work handed to the workers.  Line-major readers are opened per
+	// line, so every AMOUNT line is its own unit.  Column-major readers cover a block of lines, so the
+	// definition is cut into one contiguous block per worker.
+	deque< pair<AmsInt, AmsInt> > adtLineRanges;
+	AmsInt iLineCount = madtERSystemAssuranceDefinition->LineCount();
+
+	if(mbColumnMajorExtraction)
+	{
+		for(AmsInt iWorker = 0; iWorker < miLineWorkerCount; iWorker++)
+		{
+			AmsInt iFirstLine = iLineCount * iWorker / miLineWorkerCount;
+			AmsInt iLastLine = iLineCount * (iWorker + 1) / miLineWorkerCount - 1;
+
+			if(iFirstLine <= iLastLine)
+				adtLineRanges.push_back(pair<AmsInt, AmsInt>(iFirstLine, iLastLine));
+		}
+	}
+	else
+	{
+		for(AmsInt i = 0; i < iLineCount; i++)
+		{
+			FfsERSystemAssuranceDefinitionLinePtr padtLine =
+				(FfsERSystemAssuranceDefinitionLinePtr) madtERSystemAssuranceDefinition->GetLine(i);
+
+			if(padtLine->GetAmountsLiteralIndicator().GetValue() == FfsExternalReportAbstractDefinitionLine::AMOUNT)
+				adtLineRanges.push_back(pair<AmsInt, AmsInt>(i, i));
+		}
+	}
+
+	atomic<AmsInt> iNextRange(0);
+	deque<exception_ptr> adtErrors;
+
+	if(miLineWorkerCount <= 1)
+	{
+		adtErrors.resize(1);
+
+		try
+		{
+			ProcessLineRanges(padtNewReport, adtLineRanges, iNextRange, adtReportLines);
+		}
+		catch(...)
+		{
+			adtErrors[0] = current_exception();
+		}
+	}
+	else
+	{
+		deque<thread> adtWorkers;
+		adtErrors.resize(min<size_t>(miLineWorkerCount, adtLineRanges.size()));
+
+		for(AmsInt iWorker = 0; iWorker < adtErrors.size(); iWorker++)
+		{
+			adtWorkers.push_back(thread(&FfsERSystemAssuranceProcessor::RunLineWorker, this, padtNewReport,
+				ref(adtLineRanges), ref(iNextRange), ref(adtReportLines), ref(adtErrors[iWorker])));
+		}
+
+		for(AmsInt iWorker = 0; iWorker < adtWorkers.size(); iWorker++)
+			adtWorkers[iWorker].join();
+	}
+
+	// The lines finished before the failure are not added to the report, so they are released here
+	for(AmsInt iWorker = 0; iWorker < adtErrors.size(); iWorker++)
+	{
+		if(adtErrors[iWorker])
+		{
+			release(adtReportLines.begin(), adtReportLines.end());
+			fill(adtReportLines.begin(), adtReportLines.end(), (FfsERSystemAssuranceReportLinePtr) NULL);
+			rethrow_exception(adtErrors[iWorker]);
+		}
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::RunLineWorker(FfsERSystemAssuranceReportPtr padtNewReport, deque< pair<AmsInt, AmsInt> >& adtLineRanges,
+											 atomic<AmsInt>& iNextRange, vector<FfsERSystemAssuranceReportLinePtr>& adtReportLines,
+											 exception_ptr& adtError)
+{
+	// The copies made so far are released below whichever way the worker ends
+	map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>> adtColumnParameters;
+
+	try
+	{
+		map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>::iterator it = madtColumnParameters.begin();
+
+		for( ; it != madtColumnParameters.end(); it++)
+			adtColumnParameters[(*it).first] = new FfsERSystemAssuranceParameterGroup(*((*it).second));
+
+		mpadtWorkerConnection = AmsDBConnectionManager::GetNewReadOnlyConnection();
+		mpadtWorkerColumnParameters = &adtColumnParameters;
+
+		ProcessLineRanges(padtNewReport, adtLineRanges, iNextRange, adtReportLines);
+	}
+	catch(...)
+	{
+		// An exception must not leave the thread; it is rethrown once all workers have been joined.  The
+		// other workers finish the range they are on and take no more.
+		adtError = current_exception();
+		iNextRange = adtLineRanges.size();
+	}
+
+	mpadtWorkerColumnParameters = NULL;
+	delete mpadtWorkerConnection;
+	mpadtWorkerConnection = NULL;
+
+	release(&adtColumnParameters);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ProcessLineRanges(FfsERSystemAssuranceReportPtr padtNewReport, deque< pair<AmsInt, AmsInt> >& adtLineRanges,
+												 atomic<AmsInt>& iNextRange, vector<FfsERSystemAssuranceReportLinePtr>& adtReportLines)
+{
+	for(AmsInt iRange = iNextRange++; iRange < adtLineRanges.size(); iRange = iNextRange++)
+	{
+		AmsInt iFirstLine = adtLineRanges[iRange].first;
+		AmsInt iLastLine = adtLineRanges[iRange].second;
+
+		// In column-major mode every column is read once for the range and its rows are
+		// handed out to the lines as they are processed
+		map<AmsInt, FfsERSystemAssuranceColumnReaderPtr, less<AmsInt>> adtColumnReaders;
+		map<AmsInt, FfsERSystemAssuranceColumnReaderPtr, less<AmsInt>> adtLineReaders;
+
+		try
+		{
+			if(mbColumnMajorExtraction)
+				OpenColumnReaders(adtColumnReaders, iFirstLine, iLastLine);
+
+			ProcessLineRange(padtNewReport, adtColumnReaders, adtLineReaders, iFirstLine, iLastLine, adtReportLines);
+		}
+		catch(...)
+		{
+			release(&adtLineReaders);
+			release(&adtColumnReaders);
+			throw;
+		}
+
+		release(&adtColumnReaders);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ProcessLineRange(FfsERSystemAssuranceReportPtr padtNewReport,
+												map<AmsInt, FfsERSystemAssuranceColumnReaderPtr, less<AmsInt>>& adtColumnReaders,
+												map<AmsInt, FfsERSystemAssuranceColumnReaderPtr, less<AmsInt>>& adtLineReaders,
+												AmsInt iFirstLine, AmsInt iLastLine, vector<FfsERSystemAssuranceReportLinePtr>& adtReportLines)
+{
+	for(AmsInt i = iFirstLine; i <= iLastLine; i++)
+	{
+		FfsERSystemAssuranceDefinitionLinePtr padtLine =
+			(FfsERSystemAssuranceDefinitionLinePtr) madtERSystemAssuranceDefinition->GetLine(i);
+
+		if(padtLine->GetAmountsLiteralIndicator().GetValue() != FfsExternalReportAbstractDefinitionLine::AMOUNT)
+			continue;
+
+		if(mbColumnMajorExtraction)
+		{
+			adtReportLines[i] = ProcessLine(&adtColumnReaders, padtNewReport, padtLine, i);
+		}
+		else
+		{
+			OpenLineReaders(adtLineReaders, padtLine, i);
+
+			adtReportLines[i] = ProcessLine(&adtLineReaders, padtNewReport, padtLine, i);
+			release(&adtLineReaders);
+			adtLineReaders.clear();
+		}
+	}
+}
+
+FfsERSystemAssuranceReportLinePtr
+FfsERSystemAssuranceProcessor::ProcessLine(map<AmsInt, FfsERSystemAssuranceColumnReaderPtr, less<AmsInt>>* padtReaderMap, 
+										   FfsERSystemAssuranceReportPtr padtNewReport, FfsERSystemAssuranceDefinitionLinePtr padtLine,
+										   AmsInt iLineSequence)
+{
+	AmsString strLineNumber = padtLine->GetLineNumber().GetValue();
+	FfsERSystemAssuranceTraceSpan adtSpan("line", strLineNumber);
+	FfsERSystemAssuranceLineCounters adtCounters;
+
+	// The readers each return their cells in key order, so the line is built with a k-way merge.  The heap holds
+	// the current cell of every reader that still has rows; only the reader of the popped cell is read again.
+	priority_queue<FfsERSystemAssuranceMergeEntry, vector<FfsERSystemAssuranceMergeEntry>, FfsERSystemAssuranceMergeEntryGreater> adtCells;
+	map<AmsInt, FfsERSystemAssuranceColumnReaderPtr, less<AmsInt>>::iterator it = padtReaderMap->begin();
+
+	// Everything the line owns is kept out here, so it can be freed if reading or building a cell throws
+	FfsERSystemAssuranceReportLinePtr padtReportLine = NULL;
+	FfsERSystemAssuranceReportLineDetailPtr padtReportLineDetail = NULL;
+	FfsERSystemAssuranceReportCellDetailPtr padtCell = NULL;
+
+	// Drill-down records of the current detail are held back until the detail itself has been queued for writing
+	deque<FfsERSystemAssuranceReportActivityPtr> adtActivities;
+
+	try
+	{
+		for( ; it != padtReaderMap->end(); it++)
+		{
+			map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>::iterator itParam = GetColumnParameters().find((*it).first);
+
+			FfsERSystemAssuranceMergeEntry adtEntry;
+			adtEntry.iColumn = (*it).first;
+			adtEntry.padtColumnReader = (*it).second;
+			adtEntry.padtParameterGroup = (*itParam).second;
+			adtEntry.padtCell = NULL;
+
+			ReadNextCell(adtCells, adtEntry, strLineNumber, iLineSequence, adtCounters);
+		}
+
+		padtReportLine = CreateNewReportLine(padtNewReport, padtLine);
+
+		while(!adtCells.empty()) // there is at least one more cell to process
+		{
+			// The top of the heap is the cell with the lowest key values for the cell criteria.
+			// Popping it means we own it and need to clean it up
+			FfsERSystemAssuranceMergeEntry adtEntry = adtCells.top();
+			adtCells.pop();
+
+			padtCell = adtEntry.padtCell;
+
+			if(!padtReportLineDetail || !ReportLineMatchesCell(padtReportLineDetail, padtCell))
+			{
+				if(padtReportLineDetail)
+				{
+					EnqueueLineDetail(padtReportLineDetail, adtActivities);
+					padtReportLineDetail = NULL;
+					adtCounters.iLineDetailsWritten++;
+				}
+
+				padtReportLineDetail = CreateNewReportLineDetail(padtReportLine, padtCell);
+			}
+
+			padtReportLineDetail->AddColumnAmount(padtCell->GetColumnNumber(), padtCell->GetAmount());
+			madtTotalsGraph.AddAmount(iLineSequence, adtEntry.iColumn, padtCell->GetAmount());
+
+			// This will add the link record needed for the drill down queries.
+			AddLinkRecord(padtCell, padtReportLineDetail, adtActivities);
+			adtCounters.adtRowsWritten[adtEntry.iColumn]++;
+
+			// Cleanup
+			delete padtCell;
+			padtCell = NULL;
+
+			ReadNextCell(adtCells, adtEntry, strLineNumber, iLineSequence, adtCounters);
+		}
+
+		//Save the last one
+		if(padtReportLineDetail)
+		{
+			EnqueueLineDetail(padtReportLineDetail, adtActivities);
+			padtReportLineDetail = NULL;
+			adtCounters.iLineDetailsWritten++;
+		}
+
+		mpadtWriter->Flush();
+	}
+	catch(...)
+	{
+		delete padtCell;
+
+		for( ; !adtCells.empty(); adtCells.pop())
+			delete adtCells.top().padtCell;
+
+		release(adtActivities.begin(), adtActivities.end());
+		delete padtReportLineDetail;
+		delete padtReportLine;
+		throw;
+	}
+
+	madtRunStatistics.AddLine(strLineNumber, adtCounters);
+
+	return padtReportLine;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::PopulateReportHeader(FfsERSystemAssuranceReportPtr padtReport)
+{
+	padtReport->SetReportCode(madtERSystemAssuranceDefinition->GetCode().GetValue());
+	padtReport->SetSecurityOrganizationId(madtERSystemAssuranceDefinition->GetSecurityOrganizationId().GetValue();
+	padtReport->SetDisplayDiscrepanciesOnly(mbDisplayDiscrepanciesOnlyFlag);
+	padtReport->SetVersion(GenerateVersionNumber());
+	padtReport->SetCreationDate(AmsDate::now());
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::PopulateReportParameters(FfsERSystemAssuranceReportPtr padtReport)
+{
+	map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>::iterator it = madtColumnParameters.begin();
+
+	for( ; it != madtColumnParameters.end(); it++)
+	{
+		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = (*it).second;
+
+		FfsERSystemAssuranceReportParameterInformationPtr padtNewParameterInformation = 
+			GetPOFactory(FfsERSystemAssuranceReportParameterInformation).NewInstance();
+		padtNewParameterInformation->SetParentERSystemAssuranceReportId(padtReport->GetIdentityAspect().GetValue());
+		padtNewParameterInformation->SetReportType(padtParameterGroup->GetGroupName());
+		padtNewParameterInformation->SetColumnNumber(padtParameterGroup->GetColumnNumber());
+		padtNewParameterInformation->SetReportCode(padtParameterGroup->GetReportCode());
+		padtNewParameterInformation->SetReportVersion(padtParameterGroup->GetReportVersion());
+		padtNewParameterInformation->SetFiscalYear(padtParameterGroup->GetFiscalYear());
+		padtNewParameterInformation->SetFiscalQuarter(padtParameterGroup->GetFiscalQuarter());
+		padtNewParameterInformation->SetFiscalMonth(padtParameterGroup->GetFiscalMonth());
+		padtNewParameterInformation->SetAgency(padtParameterGroup->GetAgencyId());
+
+		mpadtWriter->Enqueue(FfsERSystemAssuranceWriter::PARAMETER_INFORMATION, padtNewParameterInformation);
+	}
+}
+
+AmsBoolean
+FfsERSystemAssuranceProcessor::ReportLineMatchesCell(FfsERSystemAssuranceReportLineDetailPtr padtDetail, FfsERSystemAssuranceReportCellDetailPtr padtCell)
+{
+	return (padtDetail->GetTreasurySymbolId().GetValue() == padtCell->GetTreasurySymbolId() && 
+	   padtDetail->GetFundId().GetValue() == padtCell->GetFundId() &&
+	   padtDetail->GetTradingPartnerId().GetValue() == padtCell->GetTradingPartnerId() &&
+	   padtDetail->GetFACTSIFundGroup().GetValue() == padtCell->GetFactsFundGroup() &&
+	   padtDetail->GetPartition().GetValue() == padtCell->GetPartition());
+}
+
+FfsERSystemAssuranceReportLinePtr
+FfsERSystemAssuranceProcessor::CreateNewReportLine(FfsERSystemAssuranceReportPtr padtReport, FfsERSystemAssuranceDefinitionLinePtr padtLine)
+{
+	FfsERSystemAssuranceReportLinePtr padtNewReportLine = GetPOFactory(FfsERSystemAssuranceReportLine).NewInstance();
+	padtNewReportLine->SetParentERSystemAssuranceReportId(padtReport->GetIdentityAspect().GetValue());
+	padtNewReportLine->SetLineNumber(padtLine->GetLineNumber().GetValue());
+
+	return padtNewReportLine;
+}
+
+FfsERSystemAssuranceReportLineDetailPtr
+FfsERSystemAssuranceProcessor::CreateNewReportLineDetail(FfsERSystemAssuranceReportLinePtr padtReportLine, FfsERSystemAssuranceReportCellDetailPtr padtCell)
+{
+	FfsERSystemAssuranceReportLineDetailPtr padtNewReportLineDetail = GetPOFactory(FfsERSystemAssuranceReportLineDetail).NewInstance();
+	padtNewReportLineDetail->SetParentERSystemAssuranceReportLineId(padtReportLine->GetIdentityValue());
+	padtNewReportLineDetail->SetLineNumber(padtCell->GetLineNumber());
+
+	padtNewReportLineDetail->SetFund(padtCell->GetFund());
+	padtNewReportLineDetail->SetBBFY(padtCell->GetBBFY());
+	padtNewReportLineDetail->SetEBFY(padtCell->GetEBFY());
+	padtNewReportLineDetail->SetPartition(padtCell->GetPartition());
+	padtNewReportLineDetail->SetTreasurySymbol(padtCell->GetTreasurySymbol());
+	padtNewReportLineDetail->SetFACTSIFundGroup(padtCell->GetFactsFundGroup());
+	padtNewReportLineDetail->SetTradingParter(padtCell->GetTradingPartner());
+
+	return padtNewReportLineDetail;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddLinkRecord(FfsERSystemAssuranceReportCellDetailPtr padtCell, 
+											 FfsERSystemAssuranceReportLineDetailPtr padtLineDetail, deque<FfsERSystemAssuranceReportActivityPtr>& adtActivities)
+{
+	FfsERSystemAssuranceReportActivityPtr padtNewReportActivity = GetPOFactory(FfsERSystemAssuranceReportActivity).NewInstance();
+	padtNewReportActivity->SetParentERSystemAssuranceReportLineDetailId(padtLineDetail->GetIdentityAspect().GetValue());
+	padtNewReportActivity->SetColumnNumber(padtCell->GetColumnNumber().GetValue());
+	padtNewReportActivity->SetReportLinkId(padtCell->GetLinkId().GetValue());
+
+	adtActivities.push_back(padtNewReportActivity);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::EnqueueLineDetail(FfsERSystemAssuranceReportLineDetailPtr padtLineDetail,
+												 deque<FfsERSystemAssuranceReportActivityPtr>& adtActivities)
+{
+	// The activities reference the detail, so none of them may reach the writer before it.  The queue is popped in
+	// order by a single thread, and an activity batch flushes the detail batch first, so the detail is always
+	// inserted before any activity that points to it.
+	mpadtWriter->Enqueue(FfsERSystemAssuranceWriter::LINE_DETAIL, padtLineDetail);
+
+	for(AmsInt i = 0; i < adtActivities.size(); i++)
+		mpadtWriter->Enqueue(FfsERSystemAssuranceWriter::ACTIVITY, adtActivities[i]);
+
+	adtActivities.clear();
+}
+
+AmsReaderPtr
+FfsERSystemAssuranceProcessor::GetReader(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, FfsERSystemAssuranceDefinitionCellPtr padtCell)
+{
+	// Covers whichever GetXxxReader the group dispatches to
+	FfsERSystemAssurancePhaseTimer adtTimer(FfsERSystemAssuranceRunStatistics::READER_OPEN);
+
+	if(padtParameterGroup->IsAbstractExternalReport())
+		return GetAbstractExternalReportReader(padtParameterGroup, padtLine, padtColumn, padtCell);
+	else if(padtParameterGroup->IsFactsAbstractExternalReport())
+		return GetFactsAbstractReportReader(padtParameterGroup, padtLine, padtColumn, padtCell);
+	else if(padtParameterGroup->IsGLRollup())
+		return GetGLRollupReader(padtParameterGroup, padtLine, padtColumn, padtCell);
+
+	return NULL;
+}
+
+AmsDBSelector
+FfsERSystemAssuranceProcessor::GetReaderCriteria(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, FfsERSystemAssuranceDefinitionCellPtr padtCell)
+{
+	if(padtParameterGroup->IsAbstractExternalReport())
+		return GetAbstractExternalReportReaderCriteria(padtParameterGroup, padtLine, padtColumn, padtCell);
+	else if(padtParameterGroup->IsFactsAbstractExternalReport())
+		return GetFactsAbstractReportReaderCriteria(padtParameterGroup, padtLine, padtColumn, padtCell);
+
+	return GetGLRollupReaderCriteria(padtParameterGroup, padtLine, padtColumn, padtCell);
+}
+
+AmsReaderPtr
+FfsERSystemAssuranceProcessor::GetNewReaderWhere(AmsBaseFactory& adtFactory, AmsDBSelector& adtSelector, AmsPartialQueryInfoPtr padtPartialQueryInfo)
+{
+	if(!madtSlowQueryLog.IsEnabled() && !madtCellStreams.IsRecording())
+		return OpenReaderWhere(adtFactory, adtSelector, padtPartialQueryInfo);
+
+	// Kept for the slow-query log entry and the recorded cell stream of the column reader that wraps this reader
+	mstrLastQuerySQL = adtSelector.asString();
+	miLastSelectorHash = FfsERSystemAssuranceSelectorHash(mstrLastQuerySQL);
+	chrono::steady_clock::time_point adtStart = chrono::steady_clock::now();
+
+	AmsReaderPtr padtReader = OpenReaderWhere(adtFactory, adtSelector, padtPartialQueryInfo);
+
+	miLastQueryOpenMicroseconds = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - adtStart).count();
+	return padtReader;
+}
+
+AmsReaderPtr
+FfsERSystemAssuranceProcessor::OpenReaderWhere(AmsBaseFactory& adtFactory, AmsDBSelector& adtSelector, AmsPartialQueryInfoPtr padtPartialQueryInfo)
+{
+	if(padtPartialQueryInfo)
+	{
+		if(mpadtWorkerConnection)
+			return adtFactory.GetPartialReaderWhere(adtSelector, padtPartialQueryInfo, mpadtWorkerConnection);
+
+		return adtFactory.GetPartialReaderWhere(adtSelector, padtPartialQueryInfo);
+	}
+
+	// Line workers read through their own connection
+	if(mpadtWorkerConnection)
+		return adtFactory.GetNewReaderWhere(adtSelector, mpadtWorkerConnection);
+
+	return adtFactory.GetNewReaderWhere(adtSelector);
+}
+
+FfsERSystemAssuranceQueryLogEntry*
+FfsERSystemAssuranceProcessor::CreateQueryLogEntry(FfsERSystemAssuranceParmeterGroupPtr padtParameterGroup, const AmsString& strLines, AmsInt iColumn)
+{
+	if(!madtSlowQueryLog.IsEnabled())
+		return NULL;
+
+	FfsERSystemAssuranceQueryLogEntry* padtEntry = new FfsERSystemAssuranceQueryLogEntry;
+	padtEntry->strDefinitionCode = mstrERSystemAssuranceCode;
+	padtEntry->strReportType = padtParameterGroup->GetGroupName();
+	padtEntry->strLines = strLines;
+	padtEntry->iColumn = iColumn;
+	padtEntry->strSQL = mstrLastQuerySQL;
+	padtEntry->adtCriteriaSize = madtCriteriaSize;
+	padtEntry->iOpenMicroseconds = miLastQueryOpenMicroseconds;
+	padtEntry->iFirstRowMicroseconds = 0;
+	padtEntry->iFetchMicroseconds = 0;
+	padtEntry->iRows = 0;
+
+	return padtEntry;
+}
+
+map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>&
+FfsERSystemAssuranceProcessor::GetColumnParameters()
+{
+	if(mpadtWorkerColumnParameters)
+		return *mpadtWorkerColumnParameters;
+
+	return madtColumnParameters;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::OpenLineReaders(map<AmsInt, FfsERSystemAssuranceColumnReaderPtr, less<AmsInt>>& adtLineReaders,
+											 FfsERSystemAssuranceDefinitionLinePtr padtLine, AmsInt iLineSequence)
+{
+	FfsERSystemAssurancePhaseTimer adtTimer(FfsERSystemAssuranceRunStatistics::READERS);
+	map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>& adtColumnParameters = GetColumnParameters();
+	map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>::iterator it = adtColumnParameters.begin();
+
+	for( ; it != adtColumnParameters.end(); it++)
+	{
+		FfsERSystemAssuranceParmeterGroupPtr padtParameterGroup = (*it).second;
+		FfsERSystemAssuranceDefinitionColumnPtr padtColumn = madtDefinitionIndex.GetColumn((*it).first);
+		FfsERSystemAssuranceDefinitionCellPtr padtCell = madtDefinitionIndex.GetCell(iLineSequence, (*it).first);
+
+		if(padtCell && padtColumn)
+		{
+			FfsERSystemAssuranceTraceSpan adtSpan("openReader", padtLine->GetLineNumber().GetValue(), (*it).first);
+			madtCriteriaSize.iPredicates = 0;
+			madtCriteriaSize.iInListMembers = 0;
+
+			FfsERSystemAssuranceColumnReaderPtr padtColumnReader = NULL;
+
+			if(madtCellStreams.IsReplaying())
+			{
+				// The selector is still built so the recorded stream is only used for the same criteria
+				if(padtParameterGroup->IsGLRollup())
+					DetermineGLFactory(padtParameterGroup, padtColumn, padtCell);
+
+				padtColumnReader = new FfsERSystemAssuranceColumnReader(NULL, FALSE);
+				padtColumnReader->SetSelectorHash(
+					FfsERSystemAssuranceSelectorHash(GetReaderCriteria(padtParameterGroup, padtLine, padtColumn, padtCell).asString()));
+			}
+			else
+			{
+				padtColumnReader = new FfsERSystemAssuranceColumnReader(GetReader(padtParameterGroup, padtLine, padtColumn, padtCell), FALSE);
+				padtColumnReader->SetSelectorHash(miLastSelectorHash);
+				padtColumnReader->SetQueryLogEntry(CreateQueryLogEntry(padtParameterGroup, padtLine->GetLineNumber().GetValue(), (*it).first));
+			}
+
+			adtLineReaders[(*it).first] = padtColumnReader;
+		}
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::OpenColumnReaders(map<AmsInt, FfsERSystemAssuranceColumnReaderPtr, less<AmsInt>>& adtColumnReaders,
+											   AmsInt iFirstLine, AmsInt iLastLine)
+{
+	FfsERSystemAssurancePhaseTimer adtTimer(FfsERSystemAssuranceRunStatistics::READERS);
+
+	// One query per column parameter group: the per-line selectors for the column are combined with UNION ALL,
+	// each branch tagged with its line sequence, so the number of queries grows with columns rather than lines x columns
+	map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>& adtColumnParameters = GetColumnParameters();
+	map<AmsInt, FfsERSystemAssuranceParameterGroupPtr, less<AmsInt>>::iterator it = adtColumnParameters.begin();
+
+	for( ; it != adtColumnParameters.end(); it++)
+	{
+		FfsERSystemAssuranceParameterGroupPtr padtParameterGroup = (*it).second;
+		FfsERSystemAssuranceDefinitionColumnPtr padtColumn = madtDefinitionIndex.GetColumn((*it).first);
+
+		if(!padtColumn)
+			continue;
+
+		FfsERSystemAssuranceTraceSpan adtSpan("openColumnReader", AmsString(), (*it).first);
+		madtCriteriaSize.iPredicates = 0;
+		madtCriteriaSize.iInListMembers = 0;
+
+		// All branches of the union have to come from the same table
+		if(padtParameterGroup->IsGLRollup())
+			DetermineGLFactory(padtParameterGroup, padtColumn);
+
+		AmsDBSelector adtColumnSelector;
+		AmsBoolean bHasCell = FALSE;
+		AmsString strFirstLineNumber;
+		AmsString strLastLineNumber;
+
+		for(AmsInt i = iFirstLine; i <= iLastLine; i++)
+		{
+			FfsERSystemAssuranceDefinitionLinePtr padtLine =
+				(FfsERSystemAssuranceDefinitionLinePtr) madtERSystemAssuranceDefinition->GetLine(i);
+
+			if(padtLine->GetAmountsLiteralIndicator().GetValue() != FfsExternalReportAbstractDefinitionLine::AMOUNT)
+				continue;
+
+			FfsERSystemAssuranceDefinitionCellPtr padtCell = madtDefinitionIndex.GetCell(i, (*it).first);
+
+			if(!padtCell)
+				continue;
+
+			AmsDBSelector adtLineSelector = GetReaderCriteria(padtParameterGroup, padtLine, padtColumn, padtCell);
+			AddLineSequenceTag(adtLineSelector, i);
+
+			if(bHasCell)
+			{
+				adtColumnSelector.unionAll(adtLineSelector);
+			}
+			else
+			{
+				adtColumnSelector = adtLineSelector;
+				strFirstLineNumber = padtLine->GetLineNumber().GetValue();
+				bHasCell = TRUE;
+			}
+
+			strLastLineNumber = padtLine->GetLineNumber().GetValue();
+		}
+
+		if(bHasCell)
+		{
+			// Lines come out in definition order.  A union does not keep the order of its branches, so within a line
+			// the rows are ordered by the source columns of the merge key for ProcessLine to merge them.
+			adtColumnSelector.orderBy(GetColumnReaderOrder(padtParameterGroup));
+			FfsERSystemAssuranceColumnReaderPtr padtColumnReader = NULL;
+
+			if(madtCellStreams.IsReplaying())
+			{
+				padtColumnReader = new FfsERSystemAssuranceColumnReader(NULL, TRUE);
+				padtColumnReader->SetSelectorHash(FfsERSystemAssuranceSelectorHash(adtColumnSelector.asString()));
+			}
+			else
+			{
+				padtColumnReader = new FfsERSystemAssuranceColumnReader(
+					GetNewReaderWhere(padtParameterGroup->GetDetailFactory(), adtColumnSelector), TRUE);
+				padtColumnReader->SetSelectorHash(miLastSelectorHash);
+				padtColumnReader->SetQueryLogEntry(CreateQueryLogEntry(padtParameterGroup, strFirstLineNumber + "-" + strLastLineNumber, (*it).first));
+			}
+
+			adtColumnReaders[(*it).first] = padtColumnReader;
+		}
+	}
+}
+
+AmsString
+FfsERSystemAssuranceProcessor::GetColumnReaderOrder(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
+{
+	// Source columns of the treasury symbol, fund, trading partner, FACTS fund group and partition of a cell
+	AmsString strOrder = LINE_SEQUENCE_COLUMN;
+
+	if(padtParameterGroup->IsAbstractExternalReport())
+		return strOrder + ", FUND, BBFY, EBFY";
+
+	if(padtParameterGroup->IsFactsAbstractExternalReport())
+	{
+		strOrder += ", TSYM_ID, FUND_ID";
+
+		if(padtParameterGroup->GetTradingPartnerAttributeIndex() >= 0)
+			strOrder += ", ATTR_" + AmsIntToStr(padtParameterGroup->GetTradingPartnerAttributeIndex() + 1) + "_VAL";
+
+		return strOrder + ", FACTS_FUND_GRP, PATN";
+	}
+
+	return strOrder + ", TSYM_ID, FUND, BBFY, EBFY, TRDG_PTNR, PATN";
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddLineSequenceTag(AmsDBSelector& adtSelector, AmsInt iLineSequence)
+{
+	adtSelector << AmsDBLiteral(AmsIntToStr(iLineSequence)).as(LINE_SEQUENCE_COLUMN);
+}
+
+AmsReaderPtr
+FfsERSystemAssuranceProcessor::GetAbstractExternalReportReader(FfsERSystemAssuranceParmeterGroupPtr padtParameterGroup, FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, FfsERSystemAssuranceDefinitionCellPtr padtCell)
+{
+	AmsDBSelector adtSelector = GetAbstractExternalReportReaderCriteria(padtParameterGroup, padtLine, padtColumn, padtCell);
+	AmsReaderPtr padtReader = GetNewReaderWhere(padtParameterGroup->GetDetailFactory(), adtSelector, GetRowProjection(padtParameterGroup));
+	return padtReader;
+}
+
+AmsDBSelector
+FfsERSystemAssuranceProcessor::GetAbstractExternalReportReaderCriteria(FfsERSystemAssuranceParmeterGroupPtr padtParameterGroup, FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, FfsERSystemAssuranceDefinitionCellPtr padtCell)
+{
+	AmsDBSelector adtSelector;
+	FfsExternalReportAbstractReportCellPtr padtSelect =
+		(FfsExternalReportAbstractReportCellPtr)padtParameterGroup->GetDetailFactory().SelectCriteriaAb();
+	padtSelect->SetParentIdentity(padtParameterGroup->GetReportId());
+	padtParameterGroup->GetDetailFactory().GetStorage()->SelectAllWhere(adtSelector, padtSelect);
+	delete padtSelect;
+
+	FfsExternalReportAbstractReportCellSQLPtr padtSQL = 
+		(FfsExternalReportAbstractReportCellSQLPtr)padtParameterGroup->GetDetailFactory().GetStorage();
+	AmsTableMapPtr padtTable = padtSQL->GetTables()->front();
+
+	AmsManyRelationPtr padtRelation = NULL;
+
+	// Add definition cell criteria
+	if(padtParameterGroup->IsFormAndContentReport())
+		padtRelation = padtCell->GetFormAndContentReportDefinitions();
+	else if(padtParameterGroup->IsSF133Report())
+      padtRelation = padtCell->GetExternalReportDefinitions();
+		
+	AddAbstractExternalReportCriteria(adtSelector, padtRelation, padtTable);
+
+	return adtSelector;
+}
+
+AmsReaderPtr
+FfsERSystemAssuranceProcessor::GetGLRollupReader(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+												 FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, 
+												 FfsERSystemAssuranceDefinitionCellPtr padtCell)
+{
+	// earlier we just assume FfsGLAcctAnnualBalByVendor as the factory
+	// now we will figure out what is the most efficient factory that we can use
+	DetermineGLFactory(padtParameterGroup, padtColumn, padtCell);
+	AmsDBSelector adtSelector = GetGLRollupReaderCriteria(padtParameterGroup, padtLine, padtColumn, padtCell);
+	AmsReaderPtr padtReader = GetNewReaderWhere(padtParameterGroup->GetDetailFactory(), adtSelector, GetRowProjection(padtParameterGroup));
+	return padtReader;
+}
+
+AmsDBSelector
+FfsERSystemAssuranceProcessor::GetGLRollupReaderCriteria(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+														 FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, 
+														 FfsERSystemAssuranceDefinitionCellPtr padtCell)
+{
+	AmsDBSelector adtSelector;
+
+	FfsGLAcctBalancePtr padtSelect = (FfsGLAcctBalancePtr)padtParameterGroup->GetDetailFactory().SelectCriteriaAb();
+	FfsGLAcctBalanceSQLPtr padtSQL = (FfsGLAcctBalanceSQLPtr)padtParameterGroup->GetDetailFactory().GetStorage();
+	AmsTableMapPtr padtTable = padtSQL->GetTables()->front();
+
+	padtSelect->SetAgency(padtParameterGroup->GetAgency());
+	padtSelect->SetFiscalYear(padtParameterGroup->GetFiscalYear());
+
+	if(!padtParameterGroup->GetFiscalMonth().isNull())
+		padtSelect->SetFiscalMonth(padtParameterGroup->GetFiscalMonth());
+
+	padtSQL->SelectAllWhere(adtSelector, padtSelect);
+	delete padtSelect;
+
+	if(!padtParameterGroup->GetFiscalQuarter().isNull())
+	{
+		adtSelector.where(adtSelector.where() && GetFiscalMonthsByQuarterCriterion(padtTable->GetTable()["FISC_MNTH"],
+			padtParameterGroup->GetFiscalYear(), padtParameterGroup->GetFiscalQuarter()));
+	}
+
+	// Add definition line criteria
+	AddGLFederalNonFederalCriteria(adtSelector, padtLine->GetFederalNonFederalIndicator().GetValue(), padtTable);
+	AddGLRollupGLAccountCriteria(adtSelector, padtParameterGroup, padtLine->GetGLAccounts(), padtTable);
+	AddTradingPartnerCriteria(adtSelector, padtParameterGroup, padtLine->GetTradingPartners(), padtTable);
+
+	// Add definition column criteria
+	AddTreasurySymbolCriteria(adtSelector, padtParameterGroup, padtColumn->GetTreasurySymbols(), padtTable);
+	AddPartitionCriteria(adtSelector, padtColumn->GetPartitions(), padtTable);
+	AddGLBureauCriteria(adtSelector, padtColumn->GetBureaus(), padtTable);
+	AddDimensionStripCriteria(adtSelector, padtColumn->GetAccountingDimensions(), padtTable);
+	AddGLFundSettingCriteria(adtSelector, padtColumn->GetFundSetting().GetValue(), padtTable);
+
+	if(padtParameterGroup->GetFactory().GetClassID() == GetPOFactory(FfsGLAcctPeriodicBalByDist).GetClassID() ||
+		padtParameterGroup->GetFactory().GetClassID() == GetPOFactory(FfsGLAcctPeriodicBalByFund).GetClassID())
+	{
+		adtSelector.where(adtSelector.where() && !GetClosingPeriodCriterion(padtTable->GetTable()["FISC_MNTH"], padtParameterGroup->GetFiscalYear()));
+	}
+
+	// Add definition cell criteria
+	AddGLRollupGLAccountCriteria(adtSelector, padtParameterGroup, padtCell->GetGLAccounts(), padtTable);
+	AddTreasurySymbolCriteria(adtSelector, padtParameterGroup, padtCell->GetTreasurySymbols(), padtTable);
+	AddPartitionCriteria(adtSelector, padtCell->GetPartitions(), padtTable);
+	AddGLBureauCriteria(adtSelector, padtCell->GetBureaus(), padtTable);
+	AddDimensionStripCriteria(adtSelector, padtCell->GetAccountingDimensions(), padtTable);
+	AddTradingPartnerCriteria(adtSelector, padtParameterGroup, padtCell->GetTradingPartners(), padtTable);
+
+	return adtSelector;
+}
+
+AmsReaderPtr
+FfsERSystemAssuranceProcessor::GetFactsAbstractReportReader(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+															FfsERSystemAssuranceDefinitionLinePtr padtLine, FfsERSystemAssuranceDefinitionColumnPtr padtColumn, 
+															FfsERSystemAssuranceDefinitionCellPtr padtCell)
+{
+	AmsDBSelector adtSelector = GetFactsAbstractReportReaderCriteria(padtParameterGroup, padtLine, padtColumn, padtCell);
+	AmsReaderPtr padtReader = GetNewReaderWhere(padtParameterGroup->GetDetailFactory(), adtSelector, GetRowProjection(padtParameterGroup));
+	return padtReader;
+}
+
+AmsDBSelector
+FfsERSystemAssuranceProcessor::GetFactsAbstractReportReaderCriteria(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+																	FfsERSystemAssuranceDefinitionLinePtr padtLine, 
+																	FfsERSystemAssuranceDefinitionColumnPtr padtColumn, 
+																	FfsERSystemAssuranceDefinitionCellPtr padtCell)
+{
+	AmsDBSelector adtSelector;
+	FfsFactsAbstractReportDetailPtr padtSelect = (FfsFactsAbstractReportDetailPtr)padtParameterGroup->GetDetailFactory().SelectCriteriaAb();
+	padtSelect->SetParentReportId(padtParameterGroup->GetReportId());
+	padtParameterGroup->GetDetailFactory().GetStorage()->SelectAllWhere(adtSelector, padtSelect);
+	delete padtSelect;
+
+	FfsFactsAbstractReportDetailSQLPtr padtSQL = (FfsFactsAbstractReportDetailSQLPtr)padtParameterGroup->GetDetailFactory().GetStorage();
+	AmsTableMapPtr padtTable = padtSQL->GetTables()->front();
+
+	// Add definition line criteria
+	AddFactsGLAccountCriteria(adtSelector, padtParameterGroup, padtLine->GetGLAccounts(), padtTable);
+	AddTradingPartnerCriteria(adtSelector, padtParameterGroup, padtLine->GetTradingPartners(), padtTable);
+	AddFactsFederalNonFederalCriteria(adtSelector, padtParameterGroup, padtLine->GetFederalNonFederalindicator().GetValue(), padtTable);
+
+	// Add definition column criteria
+	AddTreasurySymbolCriteria(adtSelector, padParameterGroup, padtColumn->GetTreasurySymbols(), padtTable);
+	AddFactsFundCriteria(adtSelector, padtParameterGroup, padtColumn->GetAccountingDimensions(), padtTable);
+
+	// Add definition cell criteria
+	AddTreasurySymbolCriteria(adtSelector, padtParameterGroup, padtCell->GetTreasurySymbols(), padtTable);
+	AddFactsFundCriteria(adtSelector, padtParameterGroup, padtCell->GetAccountingDimensions(), padtTable);
+	AddTradingPartnerCriteria(adtSelector, padtParameterGroup, padtCell->GetTradingPartners(), padtTable);
+	AddFactsGLAccountCriteria(adtSelector, padtParameterGroup, padtCell->GetGLAccounts(), padtTable)
+
+	return adtSelector;
+}
+
+AmsDBCriterion
+FfsERSystemAssuranceProcessor::GetGLAccountCriteria(const AmsString& strGLAccount, const AmsString& strGLRollupAccountBalance,
+													const AmsString& strGLUsage, AmsTableMapPtr padtTable, const AmsString& strGLACColumn, const AmsString& strSGLColumn,
+													FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
+{
+	AmsDBCriterion adtCriterion;
+	AmsString strFilterColumn = ( !strGLACColumn.isNull() ? strGLACColumn : strSGLColumn);
+	AmsBoolean bGLACId = (strGLACColumn != "GLAC");
+	AmsString strSubSelectColumn = ( bGLACId ? ( !strGLACColumn.isNull() ? "UIDY" : "STND_GL_ACCT_ID") : "CD");
+	AmsString strMonthColumn = "FISC_MNTH";
+
+	if(strGLRollupAccountBalance == FfsExternalReportAbstractDefinitionCellGLAccount::BEGINNING)
+	{
+		adtCriterion = adtCriterion && GetBeginningPeriodCriterion(padtTable->GetTable()[strMonthColumn], padtParameterGroup->GetFiscalYear());
+	}
+	else if(strGLRollupAccountBalance == FfsExternalReportAbstractDefinitionCellGLAccount::CURRENT)
+	{
+		adtCriterion = adtCriterion && !GetBeginningPeriodCriterion(padtTable->GetTable()[strMonthColumn], padtParameterGroup->GetFiscalYear());
+	}
+
+	if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::STANDARD)
+	{
+		if(!strSGLColumn.isNull()) // We have a STND_GL_ACCT_ID column
+		{
+			adtCriterion = adtCriterion && (padtTable->GetTable()[strSGLColumn] == ConvertToGLAccountId(strGLAccount, padtParameterGroup));
+		}
+		else // No STND_GL_ACCT_ID column so we need to use GLAC/GLAC_ID column
+		{
+			adtCriterion = adtCriterion && GetGLAccountInCriterion(padtTable->GetTable()[strFilterColumn], padtParameterGroup->GetFiscalYear(),
+				strSubSelectColumn, "STND_GL_ACCT_ID", ConvertToGLAccountId(strGLAccount, padtParameterGroup));
+		}
+	}
+	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::CODED)
+	{
+		if(!strGLACColumn.isNull()) // We have a GLAC or GLAC_ID column
+		{
+			adtCriterion = adtCriterion && (padtTable->GetTable()[strGLACColumn] == ( bGLACId ? ConvertToGLAccountId(strGLAccount, padtParameterGroup) : strGLAccount) );
+		}
+		else // No GLAC_ID column so we need to use SGL_ACCT_ID
+		{
+			adtCriterion = adtCriterion && GetGLAccountInCriterion(padtTable->GetTable()[strSGLColumn], padtParameterGroup->GetFiscalYear(),
+				"STND_GL_ACCT_ID", "UIDY", ConvertToGLAccountId(strGLAccount, padtParameterGroup));
+		}
+	}
+	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::SUMMARY)
+	{
+		adtCriterion = adtCriterion && GetGLAccountInCriterion(padtTable->GetTable()[strFilterColumn], padtParameterGroup->GetFiscalYear(),
+			strSubSelectColumn, "SUMR_GLAC_ID", ConvertToGLAccountId(strGLAccount, padtParameterGroup));
+	}
+	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::CATEGORY)
+	{
+		adtCriterion = adtCriterion && GetGLAccountInCriterion(padtTable->GetTable()[strFilterColumn], padtParameterGroup->GetFiscalYear(),
+			strSubSelectColumn, "ACTG_CAT_ID", strGLAccount);
+	}
+	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::CLASS)
+	{
+		adtCriterion = adtCriterion && GetGLAccountInCriterion(padtTable->GetTable()[strFilterColumn], padtParameterGroup->GetFiscalYear(),
+			strSubSelectColumn, "ACTG_CLAS_ID", strGLAccount);
+	}
+	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::GROUP)
+	{
+		adtCriterion = adtCriterion && GetGLAccountInCriterion(padtTable->GetTable()[strFilterColumn], padtParameterGroup->GetFiscalYear(),
+			strSubSelectColumn, "ACTG_GRP_ID", strGLAccount);
+	}
+	else if(strGLUsage == FfsExternalReportAbstractDefinitionCellGLAccount::TYPE)
+	{
+		adtCriterion = adtCriterion && GetGLAccountInCriterion(padtTable->GetTable()[strFilterColumn], padtParameterGroup->GetFiscalYear(),
+			strSubSelectColumn, "ACTG_TYP_ID", strGLAccount);
+	}
+
+	return adtCriterion;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddGLFederalNonFederalCriteria(AmsDBSelector& adtSelector, 
+															  const AmsString& strFederalNonFederalIndicator, AmsTableMapPtr padtTable)
+{
+	if(!strFederalNonFederalIndicator.isNull())
+	{
+		if(strFederalNonFederalIndicator == FEDERAL)
+		{ 
+			adtSelector.where(adtSelector.where() && (padtTable->GetTable()["TRDG_PTNR_TYP"] == "F" ||
+				padtTable->GetTable()["FCT1_FDRL_IN"] == "F"));
+		}
+		else
+		{
+			// Translate non federal to X/E for Trading Partner Type and N for Facts I Federal Indicator
+			adtSelector.where(adtSelector.where() && (padtTable->GetTable()["TRDG_PTNR_TYP"] == "E" ||
+				padtTable->GetTable()["TRDG_PTNR_TYP"] == "X" || padtTable->GetTable()["FCT1_FDRL_IN"] == "N"));
+		}
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddGLTransferTSYMCriteria(AmsDBSelector& adtSelector, 
+														 FfsExternalReportAbstractDefinitionCellTradingPartnerPtr padtTradingPartner, AmsTableMapPtr padtTable)
+{
+	deque<AmsString> adtIncludeDeque;
+	deque<AmsString> adtExcludeDeque;
+
+    AmsDBCriterion adtCriterion;
+    adtCriterion = padtTable->GetTable()["TRDG_PTNR"].isNull();
+    adtSelector.where(adtSelector.where() || adtCriterion);
+    AmsBoolean bInclude = padtTradingPartner->GetIncludeExcludeIndicator().GetValue();
+
+    AmsDBSelector adtTSYMSelector;
+    FfsTreasurySymbolSQLPtr padtTreasurySymbolSQL = (FfsTreasurySymbolSQLPtr).GetPOFactory(FfsTreasurySymbol).GetStorage();
+    AmsDBTable adtTreasurySymbolTable = padtTreasurySymbolSQL->GetTables()->front()->GetTable();
+    adtTSYMSelector << adtTreasurySymbolTable["UIDY"];
+    adtTSYMSelector.where(adtTSYMSelector.where() && (adtTreasurySymbolTable["S133_AGCY_ID"] == padtTradingPartner->GetTradingPartnerId().GetValue() || 
+       adtTreasurySymbolTable["SRCE_AGCY_ID"] == padtTradingPartner->GetTradingPartnerId().GetValue()));
+
+    if(mbSemiJoinCriteria)
+    {
+       if(bInclude)
+          adtSelector.where(adtSelector.where() && padtTable->GetTable()["TRFR_TSYM_ID"].in(adtTSYMSelector));
+       else
+          adtSelector.where(adtSelector.where() && !padtTable->GetTable()["TRFR_TSYM_ID"].in(adtTSYMSelector));
+
+       return;
+    }
+
+    AmsReaderPtr padtReader = GetNewReaderWhere(GetPOFactory(FfsTreasurySymbol), adtTSYMSelector);
+
+    if(padtReader)
+    {
+        while(padtReader->NextRow())
+        {
+           AmsString strIdentity;
+           (*padtReader) >> strIdentity;
+
+           if(bInclude)
+              adtIncludeDeque.push_back(strIdentity);
+	else
+              adtExcludeDeque.push_back(strIdentity);
+        }
+    }
+
+	AddCriterionToSelector(adtSelector, padtTable->GetTable()["TRFR_TSYM_ID"],
+		adtIncludeDeque, adtExcludeDeque);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddPartitionCriteria(AmsDBSelector& adtSelector,
+													AmsManyRelationPtr padtPartitions, AmsTableMapPtr padtTable)
+{
+	if(padtPartitions->Size())
+	{
+		deque<AmsString> adtIncludeDeque;
+		deque<AmsString> adtExcludeDeque;
+
+		for(AmsInt i = 0; i < padtPartitions->Size(); i++)
+		{
+			FfsExternalReportAbstractDefinitionPartitionPtr padtPartition = (*padtPartitions)[i];
+
+			adtIncludeDeque.push_back(padtPartition->GetPartition().GetValue());
+		}
+
+		AddCriterionToSelector(adtSelector, padtTable->GetTable()["PATN"], adtIncludeDeque, adtExcludeDeque);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddGLBureauCriteria(AmsDBSelector& adtSelector, 
+												   AmsManyRelationPtr padtBureaus, AmsTableMapPtr padtTable)
+{
+
+	if(padtBureaus->Size())
+	{
+		deque<AmsDBCriterion> adtIncludeDeque;
+		deque<AmsDBCriterion> adtExcludeDeque;
+
+		for(AmsInt i = 0; i < padtBureaus->Size(); i++
+		{
+			FfsExternalReportAbstractDefinitionBureauPtr padtBureau = (*padtBureaus)[i];
+			AddFundBureauCriterion(padtBureau->GetBureauId().GetValue(), adtIncludeDeque, TRUE, padtTable);
+		}
+
+		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddDimensionStripCriteria(AmsDBSelector& adtSelector
+														 AmsManyRelationPtr padtDimensionStrips, AmsTableMapPtr padtTable)
+{
+	if(padtDimensionStrips->Size())
+	{
+		deque<AmsCriterion> adtIncludeDeque;
+		deque<AmsCriterion> adtExcludeDeque;
+
+		for(AmsInt i = 0; i < padtDimensionStrips->Size(); i++)
+		{
+			FfsExternalReportAbstractDefinitionDimensionStripPtr padtDimStrip = (*padtDimensionStrips)[i];
+
+			if(padtDimStrip->GetIncludeExcludeIndicator().GetValue() == FfsExternalReportAbstractDefinitionCell::INCLUDE)
+				AddDimensionStripCriterion(padtDimStrip, adtIncludeDeque, TRUE, padtTable);
+			else
+				AddDimensionStripCriterion(padtDimStrip, adtExcludeDeque, FALSE, padtTable);
+		}
+
+		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddGLFactsAttributeCriteria(AmsDBCriterion & adtCriterion, 
+														   AmsManyRelationPtr padtFacts1Attributes, AmsManyRelationPtr padtFacts2Attributes,
+														   AmsTableMapPtr padtTable, const AmsBoolean& bInclude)
+{
+	if(padtFacts1Attributes->Size())
+	{
+		AmsDBCriterion adtAttributeCriterion;
+
+		for(AmsInt i = 0; i < padtFacts1Attributes->Size(); i++)
+		{
+
+			FFSERSystemAssuranceDefinitionCellGLFACTSPtr padtGLFacts1 = padtGLAccount->GetFacts1Attribute(i);
+
+			if(madtFactsAttributeCache.IsAttributeFlagSet(GetPOFactory(FfsFACTSAttributeDefinition), FfsERSystemAssuranceFactsAttributeCache::FACTS1,
+				padtParameterGroup->GetFiscalYear(), padtGLFacts1->GetAttributeNumber().GetValue(), "FDRL_NFDRL_FL"))
+			{
+				AddToSubCriterion(adtAttributeCriterion, padtTable->GetTable()["FCT1_FDRL_IN"], padtGLFacts1->GetDomainValue().GetValue(), bInclude);
+			}
+		}
+
+		if(bInclude)
+			adtCriterion = adtCriterion && (adtAttributeCriterion);
+		else
+			adtCriterion = adtCriterion || (adtAttributeCriterion);
+	}
+
+	if(padtFacts2Attributes->Size())
+	{
+		AmsDBCriterion adtAttributeCriterion;
+
+		for(AmsInt i = 0; i < padtFacts2Attributes->Size(); i++)
+		{
+			FFSERSystemAssuranceDefinitionCellGLFACTS2Ptr padtGLFacts2 = padtGLAccount.GetFacts2Attribute(i);
+
+			if(madtFactsAttributeCache.IsAttributeFlagSet(GetPOFactory(FfsFACTS2AttributeDefinition), FfsERSystemAssuranceFactsAttributeCache::FACTS2,
+				padtParameterGroup->GetFiscalYear(), padtGLFacts2->GetAttributeNumber().GetValue(), "YBA_FL"))
+			{
+               if(padtGLFacts2->GetDomainValue().GetValue() == FfsERSystemAssuranceProcessor::NEW)
+				{
+					if(bInclude)
+						adtAttributeCriterion = adtAttributeCriterion && padtTable->GetTable()["YBA"] >= padtParameterGroup->GetFiscalYear();
+					else
+						adtAttributeCriterion = adtAttributeCriterion || padtTable->GetTable()["YBA"] < padtParameterGroup->GetFiscalYear();
+				}
+               else if (padtGLFacts2->GetDomainValue().GetValue() == FfsERSystemAssuranceProcessor::BAL)
+				{
+					if(bInclude)
+						adtAttributeCriterion = adtAttributeCriterion && padtTable->GetTable()["YBA"] < padtParameterGroup->GetFiscalYear();
+					else
+						adtAttributeCriterion = adtAttributeCriterion || padtTable->GetTable()["YBA"] >= padtParameterGroup->GetFiscalYear();
+				}
+			}
+
+			if(padtAttribute->GetTransactionPartnerFlag().GetValue())
+			{
+				AddToSubCriterion(adtAttributeCriterion, padtTable->GetTable()["TRDG_PTNR_TYP"], padtGLFacts2->GetDomainValue().GetValue(), bInclude);
+			}
+
+			if(padtAttribute->GetPriorYearAdjustmentsFlag().GetValue())
+			{
+				AddToSubCriterion(adtAttributeCriterion, padtTable->GetTable()["PRYR_ADJM"], padtGLFacts2->GetDomainValue().GetValue(), bInclude);
+			}
+
+			if(padtAttribute->GetProgramReportingCategoryFlag())
+			{
+				AddToSubCriterion(adtAttributeCriterion, padtTable->GetTable()["PRC"], padtGLFacts2->GetDomainValue().GetValue(), bInclude);
+			}
+
+			if(padtAttribute->GetPublicLawFlag().GetValue())
+			{
+				AddToSubCriterion(adtAttributeCriterion, padtTable->GetTable()["PBLC_LAW_NUM"], padtGLFacts2->GetDomainValue().GetValue(), bInclude);
+			}
+		}
+
+		if(bInclude)
+			adtCriterion = adtCriterion && (adtAttributeCriterion);
+		else
+			adtCriterion = adtCriterion || (adtAttributeCriterion);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddToSubCriterion(AmsDBCriterion& adtCriterion, AmsDBColumn& adtColumn, const AmsString& strValue, const AmsBoolean& bInclude)
+{
+	madtCriteriaSize.iPredicates++;
+
+	if(bInclude)
+		adtCriterion = adtCriterion || adtColumn == strValue;
+	else
+		adtCriterion = adtCriterion && adtColumn != strValue;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddToCriterion(AmsDBCriterion& adtCriterion, AmsDBColumn& adtColumn, const AmsString& strValue, const AmsBoolean& bInclude)
+{
+	madtCriteriaSize.iPredicates++;
+
+	if(bInclude)
+		adtCriterion = adtCriterion && adtColumn == strValue;
+	else
+		adtCriterion = adtCriterion || adtColumn != strValue;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddGLFundSettingCriteria(AmsDBSelector& adtSelector, 
+														const AmsString& strFundSetting, AmsTableMapPtr padtTable)
+{
+	deque<AmsDBCriterion> adtIncludeDeque;
+	deque<AmsDBCriterion> adtExcludeDeque;
+
+	if(strFundSetting == FfsERSystemAssuranceDefinitionColumn::FACTS1) 
+		AddFundFactsInclusionCriterion("T", "F", adtIncludeDeque, TRUE, padtTable);
+	else if(strFundSetting == FfsERSystemAssuranceDefinitionColumn::FACTS2)
+		AddFundFactsInclusionCriterion("F", "T", adtIncludeDeque, TRUE, padtTable);
+	else if(strFundSetting == FfsERSystemAssuranceDefinitionColumn::FACTS1_FACTS2)
+		AddFundFactsInclusionCriterion("T", "T", adtIncludeDeque, TRUE, padtTable);
+
+	AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddGLRollupGLAccountCriteria(AmsDBSelector& adtSelector, 
+															FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsManyRelationPtr padtGLAccounts, AmsTableMapPtr padtTable)
+{
+	if(padtGLAccounts->Size())
+	{
+		AmsString strGLACColumn = "GLAC";
+		deque<AmsDBCriterion> adtIncludeDeque;
+		deque<AmsDBCriterion> adtExcludeDeque;
+
+		for(AmsInt i = 0; i < padtGLAccounts->Size(); i++)
+		{
+			// Create GL account criteria
+			FfsERSystemAssuranceDefinitionCellGLAccountPtr padtGLAccount = (*padtGLAccounts)[i];
+			AmsBoolean bInclude = padtGLAccount->GetIncludeExcludeIndicator().GetValue();
+			AmsString strGLAccountCriteria = padtGLAccount->GetGLAccountCriteriaByUsage();
+			AmsDBCriterion adtCriterion = GetGLAccountCriteria(strGLAccountCriteria, "", padtGLAccount->GetGLUsageIndicator.GetValue(),
+				padtTable, strGLACColumn, "", padtParameterGroup);
+
+			if(!bInclude)
+				adtCriterion = !(adtCriterion);
+
+			// Add facts attribute criteria
+			AddGLFactsAttributeCriteria(adtCriterion, padtGLAccount->GetFacts1Attributes(), padtGLAccount->GetFacts2Attributes(),
+				padtTable, bInclude);
+
+			AmsDBCriterion adtBeginningPeriodCriterion = GetBeginningPeriodCriterion(padtTable->GetTable()["FISC_MNTH"], padtParameterGroup->GetFiscalYear());
+
+			if(padtGLAccount->GetGLRollupAcctBalanceIndicator().GetValue() == FfsExternalReportAbstractDefinitionCellGLAccount::BEGINNING)
+			{
+				if(bInclude)
+				   adtCriterion = adtCriterion && (adtBeginningPeriodCriterion);
+                else
+                   adtCriterion = adtCriterion || !(adtBeginningPeriodCriterion);
+			}
+			else if(padtGLAccount->GetGLRollupAcctBalanceIndicator().GetValue() == FfsExternalReportAbstractDefinitionCellGLAccount::CURRENT)
+			{
+				if(bInclude)
+				adtCriterion = adtCriterion && !(adtBeginningPeriodCriterion);
+                else
+                   adtCriterion = adtCriterion || (adtBeginningPeriodCriterion);
+			}
+
+			// Add to the include/exclude criteria list
+			if(bInclude)
+				adtIncludeDeque.push_back(adtCriterion);
+			else
+				adtExcludeDeque.push_back(adtCriterion);
+		}
+
+		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddFactsGLAccountCriteria(AmsDBSelector& adtSelector, FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+														 AmsManyRelationPtr padtGLAccounts, AmsTableMapPtr padtTable)
+{
+	if(padtGLAccounts->Size())
+	{
+		AmsString strGLACColumn = (padtParameterGroup->IsFactsPreliminaryReport() ? "GLAC_ID" : "");
+		AmsString strSGLColumn = "SGL_ACCT_ID";
+		deque<AmsDBCriterion> adtIncludeDeque;
+		deque<AmsDBCriterion> adtExcludeDeque;
+
+		for(AmsInt i = 0; i < padtGLAccounts->Size(); i++)
+		{
+			// Create GL account criteria
+			FfsERSystemAssuranceDefinitionCellGLAccountPtr padtGLAccount = (*padtGLAccounts)[i];
+			AmsBoolean bInclude = padtGLAccount->GetIncludeExcludeIndicator().GetValue();
+			AmsString strGLAccountCriteria = padtGLAccount->GetGLAccountCriteriaByUsage();
+			AmsDBCriterion adtCriterion = GetGLAccountCriteria(strGLAccountCriteria, "", padtGLAccount->GetGLUsageIndicator.GetValue(),
+				padtTable, strGLACColumn, strSGLColumn, padtParameterGroup);
+
+			if(!bInclude)
+				adtCriterion = !(adtCriterion);
+
+
+			// Add begin/end criteria
+			if(!padtGLAccount->GetFactsIIBeginEndIndicator().GetValue().isNull() && padtParameterGroup->IsFacts2Report())
+			{
+				AddToCriterion(adtCriterion, padtTable->GetTable()["BEGN_END_IN"], padtGLAccount->GetFactsIIBeginEndIndicator().GetValue(), bInclude);
+			}
+
+			// Add facts attribute criteria
+			AddFactsAttributeCriteria(adtCriterion, padtParameterGroup, (padtParameterGroup->IsFacts1Report() ? 
+				padtGLAccount->GetFacts1Attributes() : padtGLAccount->GetFacts2Attributes()), padtTable, bInclude);
+
+			// Add to the include/exclude criteria list
+			if(bInclude)
+				adtIncludeDeque.push_back(adtCriterion);
+			else
+				adtExcludeDeque.push_back(adtCriterion);
+		}
+
+		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddFactsAttributeCriteria(AmsDBCriterion & adtCriterion,
+														 FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsManyRelationPtr padtAttributes, 
+														 AmsTableMapPtr padtTable, const AmsBoolean& bInclude)
+{
+	if(padtAttributes->Size())
+	{
+		AmsDBCriterion adtAttributeCriterion;
+
+		for(AmsInt i = 0; i < padtAttributes->Size(); i++)
+		{
+			FfsExternalReportAbstractCellGLAccountFACTS1AttributeValue padtGLFacts1;
+			FfsExternalReportAbstractCellGLAccountFACTS2AttributeValue padtGLFacts2;
+
+			if(padtParameterGroup->IsFacts1Report)
+				padtGLFacts1 = (*padtAttributes)[i];
+			else
+				padtGLFacts2 = (*padtAttributes)[i];
+
+			AmsString strAttributeNumber = (padtGLFacts1 ? padtGLFacts1->GetAttributeNumber().GetValue() : 
+				padtGLFacts2->GetAttributeNumber().GetValue());
+
+			// Remove leading zero if necessary
+			strAttributeNumber = (strAttributeNumber(0,1) == "0" ? strAttributeNumber(1) : strAttributeNumber);
+
+			AmsString strDomainValue = (padtGLFacts1 ? padtGLFacts1->GetDomainValue().GetValue() : 
+				padtGLFacts2->GetDomainValue().GetValue());
+
+			AddToSubCriterion(adtCriterion, padtTable->GetTable()["ATTR_" + strAttributeNumber + "_VAL"], strDomainValue, bInclude);
+		}
+
+		if(bInclude)
+			adtCriterion = adtCriterion && (adtAttributeCriterion);
+		else
+			adtCriterion = adtCriterion || (adtAttributeCriterion);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddTradingPartnerCriteria(AmsDBSelector& adtSelector, 
+														 FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+														 AmsManyRelationPtr padtTradingPartners, AmsTableMapPtr padtTable)
+{
+	if(padtTradingPartners->Size())
+	{
+		AmsString strTradingPartnerAttributeNumber = NULL;
+
+		// Validation drops FACTS groups without a trading partner attribute whose column selects by trading partner
+		if(padtParameterGroup->IsFactsAbstractExternalReport() && padtParameterGroup->GetTradingPartnerAttributeIndex() < 0)
+			return;
+
+		if(padtParameterGroup->IsFactsAbstractExternalReport())
+			strTradingPartnerAttributeNumber = AmsIntToStr(padtParameterGroup->GetTradingPartnerAttributeIndex() + 1);
+
+		deque<AmsString> adtIncludeDeque;
+		deque<AmsString> adtExcludeDeque;
+
+		for(AmsInt i = 0; i < padtTradingPartners->Size(); i++
+		{
+			FfsExternalReportAbstractDefinitionCellTradingPartnerPtr padtPartner = (*padtTradingPartners)[i];
+
+			if(padtPartner->GetIncludeExcludeIndicator().GetValue() == FfsExternalReportAbstractDefinitionCell::INCLUDE)
+				adtIncludeDeque.push_back(padtPartner->GetTradingPartner().GetValue());
+			else
+				adtExcludeDeque.push_back(padtPartner->GetTradingPartner().GetValue());
+		}
+
+		if(padtParameterGroup->IsFactsAbstractExternalReport())
+		{
+			AddCriterionToSelector(adtSelector, padtTable->GetTable()["ATTR_" + strTradingPartnerAttributeNumber + "_VAL"],
+				adtIncludeDeque, adtExcludeDeque);
+		}
+		else
+		{
+			AddCriterionToSelector(adtSelector, padtTable->GetTable()["TRDG_PTNR"], adtIncludeDeque, adtExcludeDeque);
+		}
+
+        if(padtParameterGroup->IsGLRollup)
+           AddGLTransferTSYMCriteria(adtSelector, padtPartner, padtTable);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddFactsFederalNonFederalCriteria(AmsDBSelector& adtSelector, 
+																 FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, const AmsString& strFederalNonFederalIndicator, AmsTableMapPtr padtTable)
+{
+	if(!strFederalNonFederalIndicator.isNull())
+	{
+		AmsString strFederalNonFederalAttributeNumber = GetFactsAttributeNumber(
+			(padtParameterGroup->IsFacts1Report() ? "TRDG_PTNR_FL" : "TRAN_PTNR_FL"), padtParameterGroup);
+
+		if(strFederalNonFederalIndicator == NON_FEDERAL && padtParameterGroup->IsFacts2Report())
+		{ // Translate non federal to X/E
+			adtSelector.where(adtSelector.where() && 
+				(padtTable->GetTable()["ATTR_" + strFederalNonFederalAttributeNumber + "_VAL"] == "X" ||
+				padtTable->GetTable()["ATTR_" + strFederalNonFederalAttributeNumber + "_VAL"] == "E"));
+		}
+		else // otherwise just use the value directly
+		{
+			adtSelector.where(adtSelector.where() && padtTable->GetTable()["ATTR_" + strFederalNonFederalAttributeNumber + "_VAL"] ==
+				strFederalNonFederalIndicator);
+		}
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddTreasurySymbolCriteria(AmsDBSelector& adtSelector,
+														 FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsManyRelationPtr padtTreasurySymbols, AmsTableMapPtr padtTable)
+{
+	if(padtTreasurySymbols->Size())
+	{
+		AmsString strColumn;
+
+		if(padtParameterGroup->IsGLRollup() || padtParameterGroup->IsFacts2Report())
+			strColumn = "TSYM";
+		else
+			strColumn = "FT_FUND_GRP";
+
+		deque<AmsString> adtIncludeDeque;
+		deque<AmsString> adtExcludeDeque;
+
+		for(AmsInt i = 0; i < padtTreasurySymbols->Size(); i++)
+		{
+			AmsString strValue;
+			FfsExternalReportAbstractDefinitionTreasurySymbolPtr padtTSYM = (*padtTreasurySymbols)[i];
+			AmsBoolean bInclude = padtTSYM->GetIncludeExcludeIndicator().GetValue();
+
+			if(padtParameterGroup->IsFacts1Report())
+				strValue = padtTSYM->GetFactsFundGroup().GetValue();
+
+			if(padtParameterGroup->IsGLRollup() || padtParameterGroup->IsFacts2Report())
+			{
+				if(bInclude)
+					AddTreasurySymbolCriterion(padtTSYM, padtParameterGroup, adtIncludeDeque, bInclude, padtTable);
+				else
+					AddTreasurySymbolCriterion(padtTSYM, padtParameterGroup, adtExcludeDeque, bInclude, padtTable);
+			}
+			else // FACTS I report
+			{
+				if(bInclude)
+					adtIncludeDeque.push_back(strValue);
+				else
+					adtExcludeDeque.push_back(strValue);
+			}
+		}
+
+		AddCriterionToSelector(adtSelector, padtTable->GetTable()[strColumn], adtIncludeDeque, adtExcludeDeque);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddFactsFundCriteria(AmsDBSelector& adtSelector, FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+														 AmsManyRelationPtr padtDimensionStrips, AmsTableMapPtr padtTable)
+{
+	if(padtDimensionStrips->Size())
+	{
+		deque<AmsDBCriterion> adtIncludeDeque;
+		deque<AmsDBCriterion> adtExcludeDeque;
+
+		for(AmsInt i = 0; i < padtDimensionStrips->Size(); i++)
+		{
+			FfsExternalReportAbstractDefinitionDimensionStripPtr padtDimStrip = (*padtDimensionStrips)[i];
+			AmsBoolean bInclude = padtDimensionStrip->GetIncludeExcludeIndicator().GetValue();
+
+			// Add fund criterion
+			if(bInclude)
+				AddFactsFundCriterion(padtDimStrip, adtIncludeDeque, bInclude, padtTable);
+			else
+				AddFactsFundCriterion(padtDimStrip, adtExcludeDeque, bInclude, padtTable);
+		}
+
+		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddAbstractExternalReportCriteria(AmsDBSelector& adtSelector,
+														 AmsManyRelationPtr padtAbstractExternalReportDefinitions, AmsTableMapPtr padtTable)
+{
+	if(padtAbstractExternalReportDefinitions->Size())
+	{
+		AmsDBCriterion adtCriterion;
+		deque<AmsCriterion> adtIncludeDeque;
+		deque<AmsCriterion> adtExcludeDeque;
+
+		for(AmsInt i = 0; i < padtAbstractExternalReportDefinitions->Size(); i++)
+		{
+			FfsERSystemAssuranceDefinitionCellAbstractExternalReportDefinitionPtr padtDefinition = (FfsERSystemAssuranceDefinitionCellAbstractExternalReportDefinitionPtr)(*padtAbstractExternalReportDefinitions)[i];
+
+			adtCriterion = padtTable->GetTable()["SEC_NUM"] == padtDefinition->GetSectionNumber().GetValue() &&
+				padtTable->GetTable()["LNUM"] == padtDefinition->GetLineNumber().GetValue() && padtTable->GetTable()["COLM_NUM"] ==
+				padtDefinition->GetColumnNumber().GetValue() && padtTable->GetTable()["TYP"] == "";
+
+			adtIncludeDeque.push_back(adtCriterion);
+		}
+
+		AddCriterionToSelector(adtSelector, adtIncludeDeque, adtExcludeDeque);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddTreasurySymbolCriterion(FfsExternalReportAbstractDefinitionTreasurySymbolPtr padtTreasurySymbol,
+														  FfsERSystemAssuranceParameterGroup padtParameterGroup,
+														  deque<AmsString> &adtDeque, const AmsBoolean& bInclude, 
+														  AmsTableMapPtr padtTable)
+{
+	AmsDBSelector adtSelector;
+	FfsTreasurySymbolSQLPtr padtTreasurySymbolSQL = (FfsTreasurySymbolSQLPtr).GetPOFactory(FfsTreasurySymbol).GetStorage();
+	AmsDBTable adtTreasurySymbolTable = padtTreasurySymbolSQL->GetTables()->front()->GetTable();
+
+	if(padtParameterGroup->IsFacts2Report())
+		adtSelector << adtTreasurySymbolTable["UIDY"];
+	else
+		adtSelector << adtTreasurySymbolTable["TSYM"];
+
+	if(padtTreasurySymbol->GetAgency().GetValue())
+	{
+		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["S133_AGCY_ID"] == 
+			padtTreasurySymbol->GetAgency().GetValue());
+	}
+
+	if(padtTreasurySymbol->GetSourceAgency().GetValue())
+	{
+		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["SRCE_AGCY_ID"] == 
+			padtTreasurySymbol->GetSourceAgency().GetValue());
+	}
+
+	if(padtTreasurySymbol->GetAvailableFromYear().GetValue())
+	{
+		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["AVAL_FROM_YEAR"] ==
+			padtTreasurySymbol->GetAvailableFromYear().GetValue());
+	}
+
+	if(padtTreasurySymbol->GetAvailableToYear().GetValue())
+	{
+		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["AVAL_TO_YEAR"] ==
+			padtTreasurySymbol->GetAvailableToYear().GetValue());
+	}
+
+	if(padtTreasurySymbol->GetAvailabilityType().GetValue())
+	{
+		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["AVAL_TYP"] ==
+			padtTreasurySymbol->GetAvailabilityType().GetValue());
+	}
+
+	if(padtTreasurySymbol->GetFundSymbol().GetValue())
+	{
+		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["FUND_SYMB"] ==
+			padtTreasurySymbol->GetFundSymbol().GetValue());
+	}
+
+	if(padtTreasurySymbol->GetSubAccount().GetValue())
+	{
+		adtSelector.where(adtSelector.where() && adtTreasurySymbolTable["SUB_ACCT"] ==
+			padtTreasurySymbol->GetSubAccount().GetValue());.
+	}
+
+	if(mbSemiJoinCriteria)
+	{
+		AmsDBColumn adtColumn = padtTable->GetTable()[padtParameterGroup->IsFacts2Report() ? "TSYM_ID" : "TSYM"];
+		AmsDBCriterion adtCriterion;
+
+		if(bInclude)
+			adtCriterion = adtColumn.in(adtSelector);
+		else
+			adtCriterion = !adtColumn.in(adtSelector);
+
+		adtDeque.push_back(adtCriterion);
+		return;
+	}
+
+	AmsGenericReaderPtr padtReader  = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+	AmsString strTSYMIdentifier;
+
+	if(padtReader)
+	{
+		while(padtReader->NextRow())
+		{
+			(*padtReader) >> strTSYMIdentifier;
+			AmsDBCriterion adtCriterion;
+
+			if(padtParameterGroup->IsFacts2Report())
+				AddToCriterion(adtCriterion, padtTable->GetTable()["TSYM_ID"], strTSYMIdentifier, bInclude);
+			else
+				AddToCriterion(adtCriterion, padtTable->GetTable()["TSYM"], strTSYMIdentifier, bInclude);
+
+			adtDeque.push_back(adtCriterion);
+		}
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddFactsFundCriterion(FfsExternalReportAbstractDefinitionDimensionStripPtr padtDimensionStrip,
+													 deque<AmsString> &adtDeque, const AmsBoolean& bInclude, AmsTableMapPtr padtTable)
+{
+	AmsDBSelector adtSelector;
+	FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr).GetPOFactory(FfsFund).GetStorage();
+	AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
+	
+	adtSelector << adtFundTable["UIDY"];
+	
+	if(padtDimensionStrip->GetFund().GetValue())
+		adtSelector.where(adtSelector.where() && adtFundTable["CD"] == padtDimensionStrip->GetFund().GetValue());
+
+	if(padtDimensionStrip->GetBegBudgetFY().GetValue())
+		adtSelector.where(adtSelector.where() && adtFundTable["BBFY"] == padtDimensionStrip->GetBegBudgetFY().GetValue());
+
+	if(padtDimensionStrip->GetEndBudgetFY().GetValue().isNull())
+    {
+        if(bInclude)
+		    adtSelector.where(adtSelector.where() && adtFundTable["EBFY"].isNull());
+	else
+            adtSelector.where(adtSelector.where() || !adtFundTable["EBFY"].isNull());
+    }
+	else
+		adtSelector.where(adtSelector.where() && adtFundTable["EBFY"] == padtDimensionStrip->GetEndBudgetFY().GetValue());
+
+	if(padtDimensionStrip->GetPartitionId().GetValue())
+		adtSelector.where(adtSelector.where() && adtFundTable["PATN_ID"] == padtDimensionStrip->GetPartitionId().GetValue());
+
+	if(mbSemiJoinCriteria)
+	{
+		AmsDBCriterion adtCriterion;
+
+		if(bInclude)
+			adtCriterion = padtTable->GetTable()["FUND_ID"].in(adtSelector);
+		else
+			adtCriterion = !padtTable->GetTable()["FUND_ID"].in(adtSelector);
+
+		adtDeque.push_back(adtCriterion);
+		return;
+	}
+
+	AmsGenericReaderPtr padtReader  = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+	AmsString strIdentity;
+	
+	if(padtReader)
+	{
+		while(padtReader->NextRow())
+		{
+			(*padtReader) >> strIdentity;
+			AmsDBCriterion adtCriterion;
+			
+			AddToCriterion(adtCriterion, padtTable->GetTable()["FUND_ID"], strIdentity, bInclude);
+
+			adtDeque.push_back(adtCriterion);
+		}
+	}
+}
+
+AmsString
+FfsERSystemAssuranceProcessor::GetFactsAttributeNumber(const AmsString& strColumn, FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
+{
+	if(padtParameterGroup->IsFacts1Report())
+	{
+		return madtFactsAttributeCache.GetAttributeNumber(GetPOFactory(FfsFACTSAttributeDefinition),
+			FfsERSystemAssuranceFactsAttributeCache::FACTS1, padtParameterGroup->GetFiscalYear(), strColumn);
+	}
+	else
+	{
+		return madtFactsAttributeCache.GetAttributeNumber(GetPOFactory(FfsFACTS2AttributeDefinition),
+			FfsERSystemAssuranceFactsAttributeCache::FACTS2, padtParameterGroup->GetFiscalYear(), strColumn);
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::InvalidateFactsAttributeCache()
+{
+	// Each fiscal year of the queued FACTS groups is dropped once, before their trading partner attributes are resolved
+	set<AmsString, less<AmsString>> adtFiscalYears;
+
+	for(AmsInt i = 0; i < madtFamilyValidations.size(); i++)
+	{
+		FfsERSystemAssuranceFamilyValidation& adtValidation = madtFamilyValidations[i];
+
+		if(!adtValidation.bFacts)
+			continue;
+
+		for(AmsInt j = 0; j < adtValidation.adtParameterGroups.size(); j++)
+			adtFiscalYears.insert(adtValidation.adtParameterGroups[j]->GetFiscalYear());
+	}
+
+	set<AmsString, less<AmsString>>::iterator it = adtFiscalYears.begin();
+
+	for( ; it != adtFiscalYears.end(); it++)
+		madtFactsAttributeCache.Invalidate(*it);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddCriterionToSelector(AmsDBSelector& adtSelector, const AmsDBColumn &adtColumn,
+													  deque<AmsString> &adtIncludeDeque, deque<AmsString> &adtExcludeDeque)
+{
+	madtCriteriaSize.iInListMembers += adtIncludeDeque.size() + adtExcludeDeque.size();
+
+	if(adtIncludeDeque.size())
+	{
+		AmsDBCriterion adtIncludeCriterion = AmsSQLHelper::BuildInClauseForStringDeque(adtColumn, adtIncludeDeque, FALSE, FALSE);
+		adtSelector.where( adtSelector.where() && ( adtIncludeCriterion ) );
+	}
+
+	if(adtExcludeDeque.size())
+	{
+		AmsDBCriterion adtExcludeCriterion = AmsSQLHelper::BuildInClauseForStringDeque(adtColumn, adtExcludeDeque, FALSE, TRUE);
+		adtSelector.where( adtSelector.where() && ( adtExcludeCriterion ) );
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddCriterionToSelector(AmsDBSelector& adtSelector, deque<AmsDBCriterion> &adtIncludeDeque, deque<AmsDBCriterion> &adtExcludeDeque)
+{
+	madtCriteriaSize.iPredicates += adtIncludeDeque.size() + adtExcludeDeque.size();
+
+	if(adtIncludeDeque.size())
+	{
+		AmsDBCriterion adtIncludeCriterion;
+
+		for(AmsInt i = 0; i < adtIncludeDeque.size(); i++)
+		{
+			AmsDBCriterion adtTempCriterion = adtIncludeDeque[i];
+			adtIncludeCriterion = adtIncludeCriterion || ( adtTempCriterion );
+		}
+
+		adtSelector.where( adtSelector.where() && ( adtIncludeCriterion ) );
+	}
+
+	if(adtExcludeDeque.size())
+	{
+		AmsDBCriterion adtExcludeCriterion;
+
+		for(AmsInt i = 0; i < adtExcludeDeque.size(); i++)
+		{
+			AmsDBCriterion adtTempCriterion = adtExcludeDeque[i];
+			adtExcludeCriterion = adtExcludeCriterion && ( adtTempCriterion );
+		}
+
+		adtSelector.where( adtSelector.where() && ( adtExcludeCriterion ) );
+	}
+}
+
+AmsString
+FfsERSystemAssuranceProcessor::ConvertToGLAccountId(const AmsString& strGLAccount, FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
+{
+	AmsString strGLAccountId;
+
+	// The index holds every account of the fiscal year, so a code it does not know has no account
+	GetGLAccountIndex(padtParameterGroup->GetFiscalYear())->FindId(strGLAccount, strGLAccountId);
+	return strGLAccountId;
+}
+
+FfsERSystemAssuranceGLAccountIndex*
+FfsERSystemAssuranceProcessor::GetGLAccountIndex(const AmsString& strFiscalYear)
+{
+	// The index map is shared by the line workers; an index is loaded once and only read afterwards
+	lock_guard<mutex> adtLock(madtGLAccountIndexMutex);
+
+	map<AmsString, unique_ptr<FfsERSystemAssuranceGLAccountIndex>>::iterator it = madtGLAccountIndexMap.find(strFiscalYear);
+
+	if(it != madtGLAccountIndexMap.end())
+		return (*it).second.get();
+
+	FfsERSystemAssuranceTraceSpan adtSpan("loadGLAccountIndex");
+	unique_ptr<FfsERSystemAssuranceGLAccountIndex>& padtIndex = madtGLAccountIndexMap[strFiscalYear];
+	padtIndex.reset(new FfsERSystemAssuranceGLAccountIndex);
+	padtIndex->Load(strFiscalYear);
+
+	return padtIndex.get();
+}
+
+AmsDBCriterion
+FfsERSystemAssuranceProcessor::GetGLAccountInCriterion(const AmsDBColumn& adtColumn, const AmsString& strFiscalYear,
+													   const AmsString& strSelectedColumn, const AmsString& strSelectedByColumn, const AmsString& strValue)
+{
+	// Accounts of any fiscal year may point to a standard or summary account, so those usages are not limited
+	// to the index's year and stay sub-selects.  An account id belongs to the index's year, so UIDY may use it.
+	if(strSelectedByColumn == "STND_GL_ACCT_ID" || strSelectedByColumn == "SUMR_GLAC_ID")
+		return adtColumn.in(GetGLSelector(strSelectedColumn, strSelectedByColumn, strValue));
+
+	deque<AmsString> adtValues;
+
+	if(GetGLAccountIndex(strFiscalYear)->GetValues(strSelectedColumn, strSelectedByColumn, strValue, adtValues))
+	{
+		madtCriteriaSize.iInListMembers += adtValues.size();
+		return AmsSQLHelper::BuildInClauseForStringDeque(adtColumn, adtValues, FALSE, FALSE);
+	}
+
+	// The index has no accounts for the value, so leave it to the database as before
+	if(strSelectedByColumn == "UIDY")
+		return adtColumn.in(GetGLSelector(strSelectedColumn, strSelectedByColumn, strValue));
+
+	return adtColumn.in(GetGLSelector(strSelectedColumn, strSelectedByColumn, strValue, "FISC_YEAR", strFiscalYear));
+}
+
+AmsDBSelector
+FfsERSystemAssuranceProcessor::GetGLSelector(const AmsString& strSelectedColumn, const AmsString& strSelectedByColumn1, const AmsString& strValue1,
+											 const AmsString& strSelectedByColumn2, const AmsString& strValue2)
+{
+	AmsDBSelector adtReturnSelector; 
+	FfsGLAccountSQLPtr padtGLSQL = (FfsGLAccountSQLPtr).GetPOFactory(FfsGLAccount).GetStorage();
+	AmsDBTable adtGLTable = padtGLSQL->GetTables()->front()->GetTable();
+	adtReturnSelector << adtGLTable[strSelectedColumn];
+	adtReturnSelector.where(adtReturnSelector.where() && adtGLTable[strSelectedByColumn1] = strValue1);
+
+	if(!strSelectedByColumn2.isNull())
+	{
+		adtReturnSelector.where(adtReturnSelector.where() && adtGLTable[strSelectedByColumn2] = strValue2);
+	}
+
+	return adtReturnSelector;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ResetFiscalYearIndexes()
+{
+	// Loaded again on first use, so accounts and periods changed since an earlier run in the process are seen
+	{
+		lock_guard<mutex> adtLock(madtGLAccountIndexMutex);
+		madtGLAccountIndexMap.clear();
+	}
+
+	lock_guard<mutex> adtLock(madtFiscalCalendarMutex);
+	madtFiscalCalendarMap.clear();
+}
+
+FfsERSystemAssuranceFiscalCalendar*
+FfsERSystemAssuranceProcessor::GetFiscalCalendar(const AmsString& strFiscalYear)
+{
+	// The calendar map is shared by the line workers; a calendar is loaded once and only read afterwards
+	lock_guard<mutex> adtLock(madtFiscalCalendarMutex);
+
+	map<AmsString, unique_ptr<FfsERSystemAssuranceFiscalCalendar>>::iterator it = madtFiscalCalendarMap.find(strFiscalYear);
+
+	if(it != madtFiscalCalendarMap.end())
+		return (*it).second.get();
+
+	FfsERSystemAssuranceTraceSpan adtSpan("loadFiscalCalendar");
+	unique_ptr<FfsERSystemAssuranceFiscalCalendar>& padtCalendar = madtFiscalCalendarMap[strFiscalYear];
+	padtCalendar.reset(new FfsERSystemAssuranceFiscalCalendar);
+	padtCalendar->Load(strFiscalYear);
+
+	return padtCalendar.get();
+}
+
+AmsDBCriterion
+FfsERSystemAssuranceProcessor::GetClosingPeriodCriterion(const AmsDBColumn& adtColumn, const AmsString& strFiscalYear)
+{
+	return GetFiscalMonthCriterion(adtColumn, GetFiscalCalendar(strFiscalYear)->GetClosingMonths(), GetClosingPeriodSelector(strFiscalYear));
+}
+
+AmsDBCriterion
+FfsERSystemAssuranceProcessor::GetBeginningPeriodCriterion(const AmsDBColumn& adtColumn, const AmsString& strFiscalYear)
+{
+	return GetFiscalMonthCriterion(adtColumn, GetFiscalCalendar(strFiscalYear)->GetBeginningMonths(), GetBeginningPeriodSelector(strFiscalYear));
+}
+
+AmsDBCriterion
+FfsERSystemAssuranceProcessor::GetFiscalMonthsByQuarterCriterion(const AmsDBColumn& adtColumn, const AmsString& strFiscalYear,
+																 const AmsString& strFiscalQuarter)
+{
+	return GetFiscalMonthCriterion(adtColumn, GetFiscalCalendar(strFiscalYear)->GetMonthsByQuarter(strFiscalQuarter),
+		GetFiscalMonthsByQuarterSelector(strFiscalYear, strFiscalQuarter));
+}
+
+AmsDBCriterion
+FfsERSystemAssuranceProcessor::GetFiscalMonthCriterion(const AmsDBColumn& adtColumn, const deque<AmsString>& adtMonths,
+													   AmsDBSelector adtFallbackSelector)
+{
+	// An empty IN list is not valid SQL, so a calendar without matching months keeps the sub-select
+	if(!adtMonths.size())
+		return adtColumn.in(adtFallbackSelector);
+
+	madtCriteriaSize.iInListMembers += adtMonths.size();
+	deque<AmsString> adtInMonths(adtMonths);
+	return AmsSQLHelper::BuildInClauseForStringDeque(adtColumn, adtInMonths, FALSE, FALSE);
+}
+
+AmsDBSelector
+FfsERSystemAssuranceProcessor::GetClosingPeriodSelector(const AmsString& strFiscalYear)
+{
+	AmsDBSelector adtReturnSelector;
+	FfsAccountingPeriodSQLPtr padtAccountingPeriodSQL = (FfsAccountingPeriodSQLPtr).GetPOFactory(FfsAccountingPeriod).GetStorage();
+	AmsDBTable adtAccountingPeriodTable = padtAccountingPeriodSQL->GetTables()->front()->GetTable();
+	adtReturnSelector << adtAccountingPeriodTable["FISC_MNTH"];
+	adtReturnSelector.where(adtReturnSelector.where() && adtAccountingPeriodTable["CLSG_PERD_FL"] == "T" 
+		&& adtAccountingPeriodTable["FISC_YEAR"] == strFiscalYear);
+	return adtReturnSelector;
+}
+
+AmsDBSelector
+FfsERSystemAssuranceProcessor::GetBeginningPeriodSelector(const AmsString& strFiscalYear)
+{
+	AmsDBSelector adtReturnSelector;
+	FfsAccountingPeriodSQLPtr padtAccountingPeriodSQL = (FfsAccountingPeriodSQLPtr).GetPOFactory(FfsAccountingPeriod).GetStorage();
+	AmsDBTable adtAccountingPeriodTable = padtAccountingPeriodSQL->GetTables()->front()->GetTable();
+	adtReturnSelector << adtAccountingPeriodTable["FISC_MNTH"];
+	adtReturnSelector.where(adtReturnSelector.where() && adtAccountingPeriodTable["BEGN_PERD_FL"] == "T"
+		&& adtAccountingPeriodTable["FISC_YEAR"] == strFiscalYear);
+	return adtReturnSelector;
+}
+
+AmsDBSelector
+FfsERSystemAssuranceProcessor::GetFiscalMonthsByQuarterSelector(const AmsString& strFiscalYear, const AmsString& strFiscalQuarter)
+{
+	AmsDBSelector adtReturnSelector;
+	FfsAccountingPeriodSQLPtr padtAccountingPeriodSQL = (FfsAccountingPeriodSQLPtr).GetPOFactory(FfsAccountingPeriod).GetStorage();
+	AmsDBTable adtAccountingPeriodTable = padtAccountingPeriodSQL->GetTables()->front()->GetTable();
+	adtReturnSelector << adtAccountingPeriodTable["FISC_MNTH"];
+	adtReturnSelector.where(adtReturnSelector.where() && adtAccountingPeriodTable["FISC_YEAR"] == strFiscalYear
+		&& adtAccountingPeriodTable["FISC_QUAR"] == strFiscalQuarter);
+	return adtReturnSelector;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ReadNextCell(priority_queue<FfsERSystemAssuranceMergeEntry, vector<FfsERSystemAssuranceMergeEntry>, FfsERSystemAssuranceMergeEntryGreater>& adtCells,
+										  FfsERSystemAssuranceMergeEntry adtEntry, const AmsString& strLineNumber, AmsInt iLineSequence,
+										  FfsERSystemAssuranceLineCounters& adtCounters)
+{
+	// Read the next object from the reader and check to see if it matches criteria.  If so, it goes on the heap.
+	// If not, keep reading until an eligible cell is found or the reader runs out of rows for the line.
+	// Only cells the builders accepted were recorded, so a replayed cell always goes on the heap
+	if(madtCellStreams.IsReplaying())
+	{
+		const FfsERSystemAssuranceCellRecord* padtRecord = NULL;
+
+		if(adtEntry.padtColumnReader)
+			padtRecord = adtEntry.padtColumnReader->NextReplayedCell(strLineNumber, adtEntry.iColumn);
+
+		if(padtRecord)
+		{
+			adtCounters.adtRowsRead[adtEntry.iColumn]++;
+
+			{
+				FfsERSystemAssuranceSampledTimer adtBuildTimer(adtCounters.iCellBuildNanoseconds, adtCounters.iCellBuilds);
+				adtEntry.padtCell = CreateReplayedCellDetail(adtEntry.padtParameterGroup, *padtRecord, strLineNumber);
+			}
+
+			adtCells.push(adtEntry);
+		}
+
+		return;
+	}
+
+	while(adtEntry.padtColumnReader)
+	{
+		{
+			FfsERSystemAssuranceSampledTimer adtFetchTimer(adtCounters.iRowFetchNanoseconds, adtCounters.iRowFetches);
+
+			if(!adtEntry.padtColumnReader->NextRow(iLineSequence))
+			{
+				if(madtCellStreams.IsRecording())
+					madtCellStreams.RecordEnd(strLineNumber, adtEntry.iColumn, adtEntry.padtColumnReader->GetSelectorHash());
+
+				break;
+			}
+		}
+
+		adtCounters.adtRowsRead[adtEntry.iColumn]++;
+
+		{
+			FfsERSystemAssuranceSampledTimer adtBuildTimer(adtCounters.iCellBuildNanoseconds, adtCounters.iCellBuilds);
+			adtEntry.padtCell = CreateReportCellDetail(adtEntry.padtParameterGroup, adtEntry.padtColumnReader->GetReader(), strLineNumber);
+		}
+
+		if(adtEntry.padtCell)
+		{
+			if(madtCellStreams.IsRecording())
+				RecordCellDetail(adtEntry.padtCell, adtEntry.iColumn, adtEntry.padtColumnReader->GetSelectorHash());
+
+			adtCells.push(adtEntry);
+			return;
+		}
+	}
+}
+
+FfsERSystemAssuranceReportCellDetailPtr
+FfsERSystemAssuranceProcessor::CreateReportCellDetail(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsReaderPtr padtReader, AmsString strLineNumber)
+{
+	if(IsProjectedRowDecode(padtParameterGroup))
+		return CreateProjectedCellDetail(padtParameterGroup, padtReader, strLineNumber);
+
+	if(padtParameterGroup->IsAbstractExternalReport())
+		return CreateAbstractExternalReportCellDetail(padtParameterGroup, padtReader, strLineNumber);
+	else if(padtParameterGroup->IsFactsAbstractExternalReport())
+		return CreateFactsAbstractReportCellDetail(padtParameterGroup, padtReader, strLineNumber);
+	else if(padtParameterGroup->IsGLRollup())
+		return CreateGLRollupCellDetail(padtParameterGroup, padtReader, strLineNumber);
+}
+
+AmsBoolean
+FfsERSystemAssuranceProcessor::IsProjectedRowDecode(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
+{
+	// A FACTS trading partner is read from one of 25 attribute aspects; those groups keep the object decode.
+	// Column-major readers select every aspect plus the line tag, so their rows do not stream in projection order.
+	if(!mbProjectedRowDecode || mbColumnMajorExtraction)
+		return FALSE;
+
+	return !padtParameterGroup->IsFactsAbstractExternalReport() || padtParameterGroup->GetTradingPartnerAttributeIndex() < 0;
+}
+
+AmsPartialQueryInfoPtr
+FfsERSystemAssuranceProcessor::GetRowProjection(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup)
+{
+	if(!IsProjectedRowDecode(padtParameterGroup))
+		return NULL;
+
+	AmsBaseFactory& adtFactory = padtParameterGroup->GetDetailFactory();
+
+	if(padtParameterGroup->IsAbstractExternalReport())
+		return madtRowProjections.Get(adtFactory, madtAbstractExternalReportProjection,
+			sizeof(madtAbstractExternalReportProjection) / sizeof(madtAbstractExternalReportProjection[0]));
+	else if(padtParameterGroup->IsFactsAbstractExternalReport())
+		return madtRowProjections.Get(adtFactory, madtFactsAbstractReportProjection,
+			sizeof(madtFactsAbstractReportProjection) / sizeof(madtFactsAbstractReportProjection[0]));
+
+	return madtRowProjections.Get(adtFactory, madtGLRollupProjection, sizeof(madtGLRollupProjection) / sizeof(madtGLRollupProjection[0]));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ReadProjectedRow(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, AmsReaderPtr padtReader,
+												FfsERSystemAssuranceProjectedRow& adtRow)
+{
+	// Columns are streamed in the order of the projection arrays; amounts are read as numbers, not parsed from text
+	FfsERSystemAssuranceDefinitionColumnPtr padtColumn = madtDefinitionIndex.GetColumn(AmsStrToInteger(padtParameterGroup->GetColumnNumber()));
+	AmsBoolean bOriginal = padtColumn->GetOriginalReportedAmountIndicator().GetValue() == FfsERSystemAssuranceDefinitionColumn::ORIGINAL;
+	double dOriginal = 0;
+	double dReported = 0;
+
+	if(padtParameterGroup->IsAbstractExternalReport())
+	{
+		(*padtReader) >> adtRow.strLinkId >> adtRow.strFund >> adtRow.strBBFY >> adtRow.strEBFY >> dOriginal >> dReported;
+		adtRow.dAmount = bOriginal ? dOriginal : dReported;
+	}
+	else if(padtParameterGroup->IsFactsAbstractExternalReport())
+	{
+		(*padtReader) >> adtRow.strLinkId >> adtRow.strPartition >> adtRow.strFactsFundGroup >> adtRow.strFundId >> adtRow.strTreasurySymbolId
+			>> dOriginal >> dReported;
+		adtRow.dAmount = bOriginal ? dOriginal : dReported;
+	}
+	else
+	{
+		double dDebit = 0;
+		double dCredit = 0;
+		(*padtReader) >> adtRow.strLinkId >> adtRow.strPartition >> adtRow.strFund >> adtRow.strBBFY >> adtRow.strEBFY
+			>> adtRow.strTreasurySymbolId >> adtRow.strTradingPartner >> dDebit >> dCredit;
+		adtRow.dAmount = dDebit - dCredit;
+	}
+}
+
+FfsERSystemAssuranceReportCellDetailPtr
+FfsERSystemAssuranceProcessor::CreateProjectedCellDetail(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+														 AmsReaderPtr padtReader, AmsString strLineNumber)
+{
+	// Same fields as the CreateXxxCellDetail builders, without materializing the source object
+	FfsERSystemAssuranceProjectedRow adtRow;
+	adtRow.dAmount = 0;
+	ReadProjectedRow(padtParameterGroup, padtReader, adtRow);
+
+	FfsERSystemAssuranceReportCellDetailPtr padtCellDetail = new FfsERSystemAssuranceReportCellDetail;
+	padtCellDetail->SetLineNumber(strLineNumber);
+	padtCellDetail->SetColumnNumber(padtParameterGroup->GetColumnNumber());
+	padtCellDetail->SetLinkId(adtRow.strLinkId);
+	padtCellDetail->SetAmount(adtRow.dAmount);
+
+	if(padtParameterGroup->IsAbstractExternalReport())
+	{
+		// The reader is restricted to the group's report
+		padtCellDetail->SetPartition(padtParameterGroup->GetReportPartition());
+
+		if(padtParameterGroup->IsSF133Report())
+		{
+			ResolveFund(adtRow);
+			padtCellDetail->SetFundId(adtRow.strFundId);
+			padtCellDetail->SetTreasurySymbolId(adtRow.strTreasurySymbolId);
+		}
+	}
+	else if(padtParameterGroup->IsFactsAbstractExternalReport())
+	{
+		padtCellDetail->SetPartition(adtRow.strPartition);
+
+		if(padtParameterGroup->IsFacts1Report())
+			padtCellDetail->SetFactsFundGroup(adtRow.strFactsFundGroup);
+
+		if(padtParameterGroup->IsFacts1PreliminaryReport())
+			padtCellDetail->SetFundId(adtRow.strFundId);
+
+		if(padtParameterGroup->IsFacts2Report())
+			padtCellDetail->SetTreasurySymbolId(adtRow.strTreasurySymbolId);
+	}
+	else
+	{
+		AmsString strTreasurySymbolId = adtRow.strTreasurySymbolId;
+		ResolveFund(adtRow);
+
+		padtCellDetail->SetPartition(adtRow.strPartition);
+		padtCellDetail->SetFundId(adtRow.strFundId);
+		padtCellDetail->SetTreasurySymbolId(strTreasurySymbolId);
+
+		AmsString strTradingPartnerId;
+
+		if(madtReferenceCache.ResolveAgencyId(adtRow.strTradingPartner, strTradingPartnerId))
+			padtCellDetail->SetTradingPartnerId(strTradingPartnerId);
+
+		FfsERSystemAssuranceReferenceCache::FundEntry adtFund;
+
+		if(madtReferenceCache.ResolveFundById(adtRow.strFundId, adtFund))
+			padtCellDetail->SetFactsFundGroup(adtFund.strFactsFundGroup);
+	}
+
+	return padtCellDetail;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::ResolveFund(FfsERSystemAssuranceProjectedRow& adtRow)
+{
+	// Sets the fund id and treasury symbol id of the row's fund code and budget fiscal years
+	FfsERSystemAssuranceReferenceCache::FundEntry adtFund;
+
+	if(madtReferenceCache.ResolveFund(adtRow.strFund, adtRow.strBBFY, adtRow.strEBFY, adtFund))
+	{
+		adtRow.strFundId = adtFund.strFundId;
+		adtRow.strTreasurySymbolId = adtFund.strTreasurySymbolId;
+	}
+	else
+	{
+		adtRow.strFundId = AmsString();
+		adtRow.strTreasurySymbolId = AmsString();
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::RecordCellDetail(FfsERSystemAssuranceReportCellDetailPtr padtCell, AmsInt iColumn, unsigned long long iSelectorHash)
+{
+	FfsERSystemAssuranceCellRecord adtRecord;
+	adtRecord.strPartition = padtCell->GetPartition();
+	adtRecord.strFundId = padtCell->GetFundId();
+	adtRecord.strTreasurySymbolId = padtCell->GetTreasurySymbolId();
+	adtRecord.strTradingPartnerId = padtCell->GetTradingPartnerId();
+	adtRecord.strTradingPartner = padtCell->GetTradingPartner();
+	adtRecord.strFactsFundGroup = padtCell->GetFactsFundGroup();
+	adtRecord.strLinkId = padtCell->GetLinkId().GetValue();
+	adtRecord.dAmount = padtCell->GetAmount();
+
+	madtCellStreams.Record(padtCell->GetLineNumber(), iColumn, iSelectorHash, adtRecord);
+}
+
+FfsERSystemAssuranceReportCellDetailPtr
+FfsERSystemAssuranceProcessor::CreateReplayedCellDetail(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+														const FfsERSystemAssuranceCellRecord& adtRecord, AmsString strLineNumber)
+{
+	FfsERSystemAssuranceReportCellDetailPtr padtCellDetail = new FfsERSystemAssuranceReportCellDetail;
+	padtCellDetail->SetLineNumber(strLineNumber);
+	padtCellDetail->SetColumnNumber(padtParameterGroup->GetColumnNumber());
+	padtCellDetail->SetPartition(adtRecord.strPartition);
+	padtCellDetail->SetFundId(adtRecord.strFundId);
+	padtCellDetail->SetTreasurySymbolId(adtRecord.strTreasurySymbolId);
+	padtCellDetail->SetTradingPartnerId(adtRecord.strTradingPartnerId);
+	padtCellDetail->SetTradingPartner(adtRecord.strTradingPartner);
+	padtCellDetail->SetFactsFundGroup(adtRecord.strFactsFundGroup);
+	padtCellDetail->SetLinkId(adtRecord.strLinkId);
+	padtCellDetail->SetAmount(adtRecord.dAmount);
+
+	return padtCellDetail;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddFundBureauCriterion(const AmsString& strBureauId, deque<AmsString> &adtDeque, const AmsBoolean& bInclude, AmsTableMapPtr padtTable)
+{
+	FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr).GetPOFactory(FfsFund).GetStorage();
+	AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
+	AmsDBCriterion adtCriterion;
+	adtCriterion = (adtFundTable["BURU_ID"] = strBureauId);
+	AddFundCriterion(adtCriterion, adtDeque, bInclude, padtTable);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddFundFactsInclusionCriterion(const AmsString& strFacts1, const AmsString& strFacts2, 
+															  deque<AmsString> &adtDeque, const AmsBoolean& bInclude, AmsTableMapPtr padtTable)
+{
+	FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr).GetPOFactory(FfsFund).GetStorage();
+	AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
+	AmsDBCriterion adtCriterion;
+	adtCriterion = (adtFundTable["FCTS_INCL_FL"] == strFacts1 && adtFundTable["FCT2_INCL_FL"] == strFacts2);
+	AddFundCriterion(adtCriterion, adtDeque, bInclude, padtTable);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddFundCriterion(AmsDBCriterion& adtCriterion, deque<AmsString> &adtDeque, const AmsBoolean& bInclude, AmsTableMapPtr padtTable)
+{
+	AmsDBSelector adtSelector;
+	FfsFundSQLPtr padtFundSQL = (FfsFundSQLPtr).GetPOFactory(FfsFund).GetStorage();
+	AmsDBTable adtFundTable = padtFundSQL->GetTables()->front()->GetTable();
+
+	AmsDBColumn adtBBFYColumn = padtTable->GetTable()["BBFY"];
+	AmsDBColumn adtEBFYColumn = padtTable->GetTable()["EBFY"];
+	AmsDBColumn adtFundColumn = padtTable->GetTable()["FUND"];
+	AmsDBColumn adtPartitionColumn = padtTable->GetTable()["PATN"];
+
+	if(mbSemiJoinCriteria)
+	{
+		// The source row qualifies when a fund matching the criterion has its code, budget fiscal years and partition
+		AmsDBSelector adtPartitionSelector;
+		FfsPartitionSQLPtr padtPartitionSQL = (FfsPartitionSQLPtr)GetPOFactory(FfsPartition).GetStorage();
+		AmsDBTable adtPartitionTable = padtPartitionSQL->GetTables()->front()->GetTable();
+		adtPartitionSelector << adtPartitionTable["UIDY"];
+		adtPartitionSelector.where(adtPartitionTable["CD"] == adtPartitionColumn);
+
+		adtSelector << adtFundTable["UIDY"];
+		adtSelector.where(adtCriterion && adtFundTable["CD"] == adtFundColumn && adtFundTable["BBFY"] == adtBBFYColumn &&
+			(adtFundTable["EBFY"] == adtEBFYColumn || (adtFundTable["EBFY"].isNull() && adtEBFYColumn.isNull())) &&
+			(adtFundTable["PATN_ID"].isNull() || adtFundTable["PATN_ID"].in(adtPartitionSelector)));
+
+		AmsDBCriterion adtExistsCriterion;
+
+		if(bInclude)
+			adtExistsCriterion = exists(adtSelector);
+		else
+			adtExistsCriterion = !exists(adtSelector);
+
+		adtDeque.push_back(adtExistsCriterion);
+		return;
+	}
+
+	adtSelector << adtFundTable["CD"];
+	adtSelector << adtFundTable["BBFY"];
+	adtSelector << adtFundTable["EBFY"];
+	adtSelector << adtFundTable["PATN_ID"];
+	adtSelector.where(adtSelector.where() && adtCriterion);
+	AmsGenericReaderPtr padtReader  = new AmsGenericReader(adtSelector, mpadtWorkerConnection);
+
+	AmsString strFund, strBBFY, strEBFY, strPartitionId;
+
+	if(padtReader)
+	{
+		while(padtReader->NextRow())
+		{
+			(*padtReader) >> strFund;
+			(*padtReader) >> strBBFY;
+			(*padtReader) >> strEBFY;
+			(*padtReader) >> strPartitionId;
+
+			AmsDBCriterion adtTempCriterion;
+
+			AddToCriterion(adtTempCriterion, adtFundColumn, strFund, bInclude);
+			AddToCriterion(adtTempCriterion, adtBBFYColumn, strBBFY, bInclude);
+
+			if(strEBFY.isNull())
+			{
+				if(bInclude)
+					adtTempCriterion = adtTempCriterion && adtEBFYColumn.isNull();
+				else
+					adtTempCriterion = adtTempCriterion || !adtEBFYColumn.isNull();
+			}
+			else
+				AddToCriterion(adtTempCriterion, adtEBFYColumn, strEBFY, bInclude);
+
+			if(!strPartitionId.isNull())
+				AddToCriterion(adtTempCriterion, adtPartitionColumn, ConvertToPartitionCode(strPartitionId), bInclude);
+
+			adtDeque.push_back(adtTempCriterion);
+		}
+	}
+}
+
+FfsERSystemAssuranceReportCellDetailPtr
+FfsERSystemAssuranceProcessor::CreateAbstractExternalReportCellDetail(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, 
+																	  AmsReaderPtr padtReader, AmsString strLineNumber)
+{
+	FfsExternalReportAbstractReportCellPtr padtCell = (FfsExternalReportAbstractReportCellPtr)(padtParameterGroup->GetDetailFactory().CreateSingleInstanceAb(padtReader));
+	FfsERSystemAssuranceReportCellDetailPtr padtCellDetail = NULL;
+
+	if(padtCell)
+	{
+		padtCellDetail = new FfsERSystemAssuranceReportCellDetail;
+		FfsERSystemAssuranceDefinitionColumnPtr padtColumn = madtDefinitionIndex.GetColumn(AmsStrToInteger(padtParameterGroup->GetColumnNumber()));
+
+		padtCellDetail->SetLineNumber(strLineNumber);
+		padtCellDetail->SetColumnNumber(padtParameterGroup->GetColumnNumber());
+
+		// The reader selects the cells of the group's report only, whose partition CheckReportExistence kept
+		padtCellDetail->SetPartition(padtParameterGroup->GetReportPartition());
+
+		padtCellDetail->SetLinkId(padtCell->GetIdentityValue());
+
+		if(padtColumn->GetOriginalReportedAmountIndicator().GetValue() == FfsERSystemAssuranceDefinitionColumn::ORIGINAL)
+			padtCellDetail->SetAmount(padtCell->GetOriginalAmount().GetValue());
+		else if(padtColumn->GetOriginalReportedAmountIndicator().GetValue() = FfsERSystemAssuranceDefinitionColumn::REPORTED)
+			padtCellDetail->SetAmount(padtCell->GetTotalAmount().GetValue());
+
+		FfsERSystemAssuranceReferenceCache::FundEntry adtFund;
+
+		if(padtParameterGroup->IsSF133Report() && madtReferenceCache.ResolveFund(padtCell->GetFund().GetValue(),
+			padtCell->GetBeginningBudgetFiscalYear().GetValue(), padtCell->GetEndingBudgetFiscalYear().GetValue(), adtFund))
+		{
+			padtCellDetail->SetFundId(adtFund.strFundId);
+			padtCellDetail->SetTreasurySymbolId(adtFund.strTreasurySymbolId);
+		}
+
+		delete padtCell;
+	}
+
+	return padtCellDetail;
+}
+
+FfsERSystemAssuranceReportCellDetailPtr
+FfsERSystemAssuranceProcessor::CreateFactsAbstractReportCellDetail(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, 
+																   AmsReaderPtr padtReader, AmsString strLineNumber)
+{
+	FfsFactsAbstractReportDetailPtr padtDetail = NULL;
+	FfsERSystemAssuranceReportCellDetailPtr padtCellDetail = NULL;
+
+	padtDetail = (FfsFactsAbstractReportDetailPtr)(GetFactory().CreateSingleInstanceAb(padtReader));
+
+	if(padtDetail)
+	{
+		padtCellDetail = new FfsERSystemAssuranceReportCellDetail;
+		FfsERSystemAssuranceDefinitionColumnPtr padtColumn = madtDefinitionIndex.GetColumn(AmsStrToInteger(padtParameterGroup->GetColumnNumber()));
+
+		padtCellDetail->SetLineNumber(strLineNumber);
+		padtCellDetail->SetColumnNumber(padtParameterGroup->GetColumnNumber());
+		padtCellDetail->SetPartition(padtDetail->GetPartition().GetValue());
+
+		if(padtParameterGroup->IsFacts1Report())
+			padtCellDetail->SetFactsFundGroup(padtDetail->GetFactsFundGroup().GetValue());
+
+		if(padtParameterGroup->IsFacts1PreliminaryReport())
+			padtCellDetail->SetFundId(padtDetail->GetFundId().GetValue());
+
+		if(padtParameterGroup->IsFacts2Report())
+			padtCellDetail->SetTreasurySymbolId(padtDetail->GetTreasurySymbolId().GetValue());
+
+		AmsInt iTradingPartnerAttribute = padtParameterGroup->GetTradingPartnerAttributeIndex();
+
+		if(iTradingPartnerAttribute >= 0)
+			padtCellDetail->SetTradingPartner((padtDetail->*madtFactsAttributeAccessors[iTradingPartnerAttribute])());
+
+		padtCellDetail->SetLinkId(padtDetail->GetIdentityValue());
+
+		if(padtColumn->GetOriginalReportedAmountIndicator().GetValue() == FfsERSystemAssuranceDefinitionColumn::ORIGINAL)
+			padtCellDetail->SetAmount(padtCell->GetOriginalAmount().GetValue());
+		else if(padtColumn->GetOriginalReportedAmountIndicator().GetValue() = FfsERSystemAssuranceDefinitionColumn::REPORTED)
+			padtCellDetail->SetAmount(padtCell->GetReportedAmount().GetValue());
+
+		delete padtDetail;
+	}
+
+	return padtCellDetail;
+}
+
+FfsERSystemAssuranceReportCellDetailPtr
+FfsERSystemAssuranceProcessor::CreateGLRollupCellDetail(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, 
+														AmsReaderPtr padtReader, AmsString strLineNumber)
+{
+	FfsGLAcctBalancePtr padtBalance = (FfsGLAcctBalancePtr)(GetFactory().CreateSingleInstanceAb(padtReader));
+	FfsERSystemAssuranceReportCellDetailPtr padtCellDetail = NULL;
+
+	if(padtBalance)
+	{
+		padtCellDetail = new FfsERSystemAssuranceReportCellDetail;
+		padtCellDetail->SetLineNumber(strLineNumber);
+		padtCellDetail->SetColumnNumber(padtParameterGroup->GetColumnNumber());
+		padtCellDetail->SetPartition(padtBalance->GetPartition().GetValue());
+		padtCellDetail->SetFundId(padtBalance->GetFundAsIdentity());
+		padtCellDetail->SetTreasurySymbolId(padtBalance->GetTreasurySymbolId().GetValue());
+
+		AmsString strTradingPartnerId;
+
+		if(madtReferenceCache.ResolveAgencyId(padtBalance->GetTradingPartner().GetValue(), strTradingPartnerId))
+			padtCellDetail->SetTradingPartnerId(strTradingPartnerId);
+
+		FfsERSystemAssuranceReferenceCache::FundEntry adtFund;
+
+		if(madtReferenceCache.ResolveFundById(padtBalance->GetFundAsIdentity(), adtFund))
+			padtCellDetail->SetFactsFundGroup(adtFund.strFactsFundGroup);
+
+		padtCellDetail->SetLinkId(padtBalance->GetIdentityValue());
+		padtCellDetail->SetAmount(padtBalance->GetDebitBalance().GetValue() - padtBalance->GetCreditBalance().GetValue());
+
+		delete padtBalance;
+	}
+
+	return padtCellDetail;
+}
+
+FfsERSystemAssuranceReportLinePtr
+FfsERSystemAssuranceProcessor::CreateTotalsLine(FfsERSystemAssuranceReportPtr padtReport, FfsERSystemAssuranceDefinitionLinePtr padtLine,
+												AmsInt iLineSequence)
+{
+	// The amounts were evaluated by the totals graph; the line only has to be filled from them
+	FfsERSystemAssuranceReportLinePtr padtReportLine = CreateNewReportLine(padtReport, padtLine);
+	FillReportLine(padtReportLine, iLineSequence);
+
+	return padtReportLine;
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::FillReportLine(FfsERSystemAssuranceReportLinePtr padtReportLine, AmsInt iLineSequence)
+{
+	// Amount lines are filled here too, with their source columns and total columns, instead of one call per cell.
+	// Total columns are only evaluated per line, so their amounts appear on report lines and never on line details.
+	// Columns without a parameter group or total are left off the line, as they were before the amounts were kept in the array.
+	for(size_t i = 0; i < madtTotalsGraph.ColumnCount(); i++)
+	{
+		AmsInt iColumn = AmsStrToInteger(madtTotalsGraph.GetColumnNumber(i));
+
+		if(madtColumnParameters.find(iColumn) != madtColumnParameters.end() || madtTotalsGraph.IsColumnTotal(iColumn))
+			padtReportLine->AddColumnAmount(madtTotalsGraph.GetColumnNumber(i), madtTotalsGraph.GetAmount(iLineSequence, i));
+	}
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::DetermineGLFactory(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+												  FfsERSystemAssuranceDefinitionColumnPtr padtColumn, FfsERSystemAssuranceDefinitionCellPtr padtCell)
+{
+	AmsManyRelationPtr padtColumnDimensions = padtColumn->GetColumnDimensionStrip();
+	AmsManyRelationPtr padtCellDimensions = padtCell->GetDimensionStrip();
+
+	SetGLFactory(padtParameterGroup, ShouldDistributionTableBeUsed(padtColumnDimensions, padtCellDimensions));
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::DetermineGLFactory(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup,
+												  FfsERSystemAssuranceDefinitionColumnPtr padtColumn)
+{
+	// A column-major reader covers every cell of the column with one query, so if any cell needs
+	// the distribution table the whole column has to read from it
+	AmsManyRelationPtr padtColumnDimensions = padtColumn->GetColumnDimensionStrip();
+	AmsBoolean bUseDistribution = FALSE;
+
+	AmsInt iColumn = AmsStrToULong(padtParameterGroup->GetColumnNumber());
+
+	for(AmsInt i = 0; i < madtERSystemAssuranceDefinition->LineCount() && !bUseDistribution; i++)
+	{
+		FfsERSystemAssuranceDefinitionCellPtr padtCell = madtDefinitionIndex.GetCell(i, iColumn);
+
+		if(padtCell)
+			bUseDistribution = ShouldDistributionTableBeUsed(padtColumnDimensions, padtCell->GetDimensionStrip());
+	}
+
+	SetGLFactory(padtParameterGroup, bUseDistribution);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::SetGLFactory(FfsERSystemAssuranceParameterGroupPtr padtParameterGroup, const AmsBoolean& bUseDistribution)
+{
+	if(padtParameterGroup->GetFiscalMonth().isNull() && padtParameterGroup->GetFiscalQuarter().isNull()) // annual
+	{
+		if(bUseDistribution)
+		{
+			padtParameterGroup->SetFactory(GetPOFactory(FfsGLAcctAnnualBalByDist));
+			padtParameterGroup->SetDetailFactory(GetPOFactory(FfsGLAcctAnnualBalByDist));
+		}
+		else
+		{
+			padtParameterGroup->SetFactory(GetPOFactory(FfsGLAcctAnnualBalByFund));
+			padtParameterGroup->SetDetailFactory(GetPOFactory(FfsGLAcctAnnualBalByFund));
+		}
+	}
+	else
+	{
+		if(bUseDistribution)
+		{
+			padtParameterGroup->SetFactory(GetPOFactory(FfsGLAcctPeriodicBalByDist));
+			padtParameterGroup->SetDetailFactory(GetPOFactory(FfsGLAcctPeriodicBalByDist));
+		}
+		else
+		{
+			padtParameterGroup->SetFactory(GetPOFactory(FfsGLAcctPeriodicBalByFund));
+			padtParameterGroup->SetDetailFactory(GetPOFactory(FfsGLAcctPeriodicBalByFund));
+		}
+	}
+}
+
+AmsBoolean
+FfsERSystemAssuranceProcessor::ShouldDistributionTableBeUsed(AmsManyRelationPtr padtColumnDimensions, 
+                                                             AmsManyRelationPtr padtCellDimensions)
+{
+   // This method iterates through the column and cell dimension strips to see if anything other than fund
+   // dimensions have been entered.  If so, it returns TRUE indicating that a GL Rollup Distribution table
+   // should be used for the GL Factory.
+   for(AmsInt i = 0; i < padtColumnDimensions->Size(); i++)
+   {
+      FfsERSystemAssuranceDefinitionColumnDimensionStripPtr padtColumnStrip = padtColumn->GetColumnDimensionStrip(i);
+      FfsDimensionStripWithRollups& adtRollupStrip = padtColumnStrip->GetDimensionStrip();
+
+      deque < FfsDimensionReferencePtr > & adtDimensionStripDeque = adtRollupStrip.GetCompleteReferences();
+      deque < FfsDimensionReferencePtr > ::iterator adtDimensionStripIterator = adtDimensionStripDeque.begin();
+      FfsPartitionReference adtPartitionRef;
+      FfsFundReference adtFundRef;
+
+      for( ; adtDimensionStripIterator != adtDimensionStripDeque.end(); adtDimensionStripIterator++)
+      {
+         FfsDimensionReferencePtr padtDimension = (*adtDimensionStripIterator);
+
+         if((padtDimension->GetLabel() != adtPartitionRef.GetLabel() || padtDimension->GetLabel() != adtFundRef.GetLabel()) &&
+             padtDimension->GetCodeAspect().GetValue())
+         {
+            return TRUE;
+		}
+	}
+}
+
+   for(AmsInt i = 0; i < padtCellDimensions->Size; i++)
+   {
+      FfsERSystemAssuranceDefinitionCellDimensionStripPtr padtCellStrip = 
+         (FfsERSystemAssuranceDefinitionCellDimensionStripPtr)padtCell->GetDimensionStrip(i);
+      FfsDimensionStripWithRollups& adtRollupStrip = padtCellStrip->GetDimensionStrip();
+
+      deque < FfsDimensionReferencePtr > & adtDimensionStripDeque = adtRollupStrip.GetCompleteReferences();
+      deque < FfsDimensionReferencePtr > ::iterator adtDimensionStripIterator = adtDimensionStripDeque.begin();
+      FfsPartitionReference adtPartitionRef;
+      FfsFundReference adtFundRef;
+
+      for( ; adtDimensionStripIterator != adtDimensionStripDeque.end(); adtDimensionStripIterator++)
+      {
+         FfsDimensionReferencePtr padtDimension = (*adtDimensionStripIterator);
+
+         if((padtDimension->GetLabel() != adtPartitionRef.GetLabel() || padtDimension->GetLabel() != adtFundRef.GetLabel()) &&
+             padtDimension->GetCodeAspect().GetValue())
+         {
+            return TRUE;
+         }
+      }
+   }
+
+   return FALSE;
+}
+
+AmsString
+FfsERSystemAssuranceProcessor::ConvertToPartitionCode(strPartitionId)
+{
+	AmsString strPartitionCode;
+
+	if(madtReferenceCache.ResolvePartitionCode(strPartitionId, strPartitionCode))
+		return strPartitionCode;
+
+	return AmsString();
+}
+
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddToCriterionIfNotNull(AmsDBCriterion& adtCriterion, AmsTableMapPtr padtTable, 
+                        const AmsString& strColumnName, const AmsSting& strValue, const AmsBoolean& bInclude)
+{
+	if(!strValue.isNull())
+		AddToCriterion(adtCriterion, padtTable->GetTable()[strColumnName], strValue), bInclude);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::AddDimensionStripCriterion(FfsExternalReportAbstractDefinitionDimensionStripPtr padtDimStrip,
+														  deque<AmsCriterion> &adtDeque, const AmsBoolean& bInclude, AmsTableMapPtr padtTable)
+{
+	AmsDBCriterion adtCriterion;
+
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "TSYM", padtDimStrip->GetTreasurySymbol().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "PATN", padtDimStrip->GetDimensionStrip().GetPartition().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "BBFY", padtDimStrip->GetDimensionStrip().GetBegBudgetFY().GetValue(), bInclude);
+
+    AmsDBColumn adtEBFYColumn = padtTable->GetTable()["EBFY"];
+
+    if(padtDimStrip->GetDimensionStrip().GetEndBudgetFY().GetValue().isNull())
+    {
+        if(bInclude)
+           adtCriterion = adtCriterion && adtEBFYColumn.isNull();
+        else
+           adtCriterion = adtCriterion || !adtEBFYColumn.isNull();
+    }
+
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "EBFY", padtDimStrip->GetDimensionStrip().GetEndBudgetFY().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "FUND", padtDimStrip->GetDimensionStrip().GetFund().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "DIV", padtDimStrip->GetDimensionStrip().GetDivision().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "ORGN", padtDimStrip->GetDimensionStrip().GetOrganization().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "SUB_ORGN", padtDimStrip->GetDimensionStrip().GetSubOrganization().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "PROG", padtDimStrip->GetDimensionStrip().GetProgram().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "PROJ", padtDimStrip->GetDimensionStrip().GetProject().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "SUB_PROJ", padtDimStrip->GetDimensionStrip().GetSubProject().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "ACTY", padtDimStrip->GetDimensionStrip().GetActivity().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "BDOB", padtDimStrip->GetDimensionStrip().GetBudgetObject().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "SBOB", padtDimStrip->GetDimensionStrip().GetSubBudgetObject().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "REV_SRCE", padtDimStrip->GetDimensionStrip().GetRevenueSource().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "SREV_SRCE", padtDimStrip->GetDimensionStrip().GetSubRevenueSource().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM1", padtDimStrip->GetDimensionStrip().GetUserDimension1().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM2", padtDimStrip->GetDimensionStrip().GetUserDimension2().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM3", padtDimStrip->GetDimensionStrip().GetUserDimension3().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM4", padtDimStrip->GetDimensionStrip().GetUserDimension4().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM5", padtDimStrip->GetDimensionStrip().GetUserDimension5().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM6", padtDimStrip->GetDimensionStrip().GetUserDimension6().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM7", padtDimStrip->GetDimensionStrip().GetUserDimension7().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM8", padtDimStrip->GetDimensionStrip().GetUserDimension8().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM9", padtDimStrip->GetDimensionStrip().GetUserDimension9().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "USER_DM10", padtDimStrip->GetDimensionStrip().GetUserDimension10().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "REIM_BDOB", padtDimStrip->GetDimensionStrip().GetReimbBudgetObject().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "REIM_SBOB", padtDimStrip->GetDimensionStrip().GetReimbSubBudgetObject().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "CAND_BBFY", padtDimStrip->GetDimensionStrip().GetClosedBegBudgetFY().GetValue(), bInclude);
+
+    AmsDBColumn adtClosedEBFYColumn = padtTable->GetTable()["CAND_EBFY"];
+
+    if(padtDimStrip->GetDimensionStrip().GetClosedEndBudgetFY().GetValue().isNull())
+    {
+       if(bInclude)
+          adtCriterion = adtCriterion && adtClosedEBFYColumn.isNull();
+       else
+          adtCriterion = adtCriterion || !adtClosedEBFYColumn.isNull();
+    }
+
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "CAND_EBFY", padtDimStrip->GetDimensionStrip().GetClosedEndBudgetFY().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, "CAND_FUND", padtDimStrip->GetDimensionStrip().GetClosedFund().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "COST_ORGN", padtDimStrip->GetDimensionStrip().GetCostOrganization().GetValue(), bInclude);
+	AddToCriterionIfNotNull(adtCriterion, padtTable, "SCST_ORGN", padtDimStrip->GetDimensionStrip().GetSubCostOrganization().GetValue(), bInclude);
+
+	adtDeque.push_back(adtCriterion);
+}
+
+AmsVoid
+FfsERSystemAssuranceProcessor::HandleDisplayDiscrepancies(FfsERSystemAssuranceReportPtr padtNewReport)
+{
+	FfsERSystemAssurancePhaseTimer adtTimer(FfsERSystemAssuranceRunStatistics::DISCREPANCIES);
+
+	if(!mbDisplayDiscrepanciesOnlyFlag)
+		return;
+
+	for(AmsInt i = 0; i < madtERSystemAssuranceDefinition->ColumnCount(); i++)
+	{
+		FfsERSystemAssuranceDefinitionColumnPtr padtColumn = (FfsERSystemAssuranceDefinitionColumnPtr) madtERSystemAssuranceDefinition->GetColumn(i);
+
+		if(padtColumn->GetAmountsLiteralsIndicator().GetValue() == FfsExternalReportAbstractDefinitionColumn::TOTAL)
+			{
+				
+		}
+	}
 }
\ No newline at end of file